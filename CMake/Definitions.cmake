@@ -14,6 +14,9 @@ foreach(
   GPERF_HEAP_FIRST_GAME_ITERATION
   STREAM_ALL_AUDIO
   PACKET_ENCRYPTION
+  PACKET_BUNDLING
+  MEMORY_ACCOUNTING
+  TICK_STATS
 )
   if(${def_name})
     list(APPEND DEVILUTIONX_DEFINITIONS ${def_name})
@@ -29,6 +32,7 @@ foreach(
   DEFAULT_AUDIO_CHANNELS
   DEFAULT_AUDIO_BUFFER_SIZE
   DEFAULT_AUDIO_RESAMPLING_QUALITY
+  MAXMISSILES
   SDL1_VIDEO_MODE_BPP
   SDL1_VIDEO_MODE_FLAGS
   SDL1_VIDEO_MODE_SVID_FLAGS
@@ -136,6 +136,8 @@ endif()
 
 if(EMSCRIPTEN)
   emscripten_system_library("zlib" ZLIB::ZLIB USE_ZLIB=1)
+else()
+  find_package(ZLIB REQUIRED)
 endif()
 
 add_subdirectory(3rdParty/libsmackerdec)
@@ -179,3 +181,12 @@ if(BUILD_TESTING)
     add_subdirectory(3rdParty/googletest)
   endif()
 endif()
+
+if(BUILD_BENCHMARKS)
+  dependency_options("benchmark" DEVILUTIONX_SYSTEM_BENCHMARK ON DEVILUTIONX_STATIC_BENCHMARK)
+  if(DEVILUTIONX_SYSTEM_BENCHMARK)
+    find_package(benchmark REQUIRED)
+  else()
+    add_subdirectory(3rdParty/benchmark)
+  endif()
+endif()
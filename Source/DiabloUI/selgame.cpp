@@ -9,6 +9,7 @@
 #include "DiabloUI/selok.h"
 #include "config.h"
 #include "control.h"
+#include "encrypt.h"
 #include "menu.h"
 #include "options.h"
 #include "storm/storm_net.hpp"
@@ -457,7 +458,8 @@ static bool IsGameCompatible(const GameData &data)
 	if (data.versionMajor == PROJECT_VERSION_MAJOR
 	    && data.versionMinor == PROJECT_VERSION_MINOR
 	    && data.versionPatch == PROJECT_VERSION_PATCH
-	    && data.programid == GAME_ID) {
+	    && data.programid == GAME_ID
+	    && data.deltaCodec <= static_cast<uint8_t>(CompressionCodec::Zlib)) {
 		return IsDifficultyAllowed(data.nDifficulty);
 	}
 
@@ -3,196 +3,246 @@
  *
  * Implementation of the screenshot function.
  */
+#include "capture.h"
+
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <fstream>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include <fmt/format.h>
 
-#include "DiabloUI/diabloui.h"
 #include "dx.h"
 #include "palette.h"
+#include "plrmsg.h"
 #include "utils/file_util.h"
+#include "utils/language.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
-#include "utils/pcx.hpp"
-#include "utils/ui_fwd.h"
+#include "utils/png.h"
+#include "utils/sdl_compat.h"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_thread.h"
+#include "utils/sdl_wrap.h"
+#include "utils/spsc_queue.hpp"
+#include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
+
 namespace {
 
-/**
- * @brief Write the PCX-file header
- * @param width Image width
- * @param height Image height
- * @param out File stream to write to
- * @return True on success
- */
-bool CaptureHdr(int16_t width, int16_t height, std::ofstream *out)
-{
-	PCXHeader buffer;
-
-	memset(&buffer, 0, sizeof(buffer));
-	buffer.Manufacturer = 10;
-	buffer.Version = 5;
-	buffer.Encoding = 1;
-	buffer.BitsPerPixel = 8;
-	buffer.Xmax = SDL_SwapLE16(width - 1);
-	buffer.Ymax = SDL_SwapLE16(height - 1);
-	buffer.HDpi = SDL_SwapLE16(width);
-	buffer.VDpi = SDL_SwapLE16(height);
-	buffer.NPlanes = 1;
-	buffer.BytesPerLine = SDL_SwapLE16(width);
-
-	out->write(reinterpret_cast<const char *>(&buffer), sizeof(buffer));
-	return !out->fail();
-}
+#ifdef USE_SDL1
+// SDL_image 1.2 can't write PNG files
+constexpr const char *CaptureExtension = "bmp";
+#else
+constexpr const char *CaptureExtension = "png";
+#endif
+
+/** Copy of the back buffer and palette, saved to a file by the capture thread */
+struct CapturedFrame {
+	std::string path;
+	std::unique_ptr<uint8_t[]> pixels;
+	int width;
+	int height;
+	std::array<SDL_Color, 256> palette;
+};
 
 /**
- * @brief Write the current in-game palette to the PCX file
- * @param palette Current palette
- * @param out File stream for the PCX file.
- * @return True if successful, else false
+ * Frames are queued by the game thread and encoded by the capture thread. When the queue is full,
+ * frames are dropped, unless an offline capture asked to wait for the encoder.
  */
-bool CapturePal(SDL_Color *palette, std::ofstream *out)
+SpscQueue<CapturedFrame, 8> CaptureQueue;
+std::atomic<bool> CaptureThreadRunning;
+/** Only used to let the capture thread sleep while the queue is empty */
+std::optional<SdlMutex> CaptureMutex;
+std::optional<SdlCond> WorkToDo;
+SdlThread Thread;
+
+/** First screenshot number that may be free, the files of queued screenshots don't exist yet */
+int NextScreenshot;
+/** Where StartFrameCapture saves the frames, including the file name prefix */
+std::string FramePathPrefix;
+/** Frames left to capture, -1 to capture until StopFrameCapture */
+int FramesToCapture;
+/** Whether the game waits for the encoder instead of dropping frames, see StartFrameCapture */
+bool WaitForEncoder;
+int CapturedFrames;
+/** Frames of the current capture that were dropped because the encoder fell behind */
+int DroppedFrames;
+
+void SaveFrame(CapturedFrame &frame)
 {
-	BYTE pcxPalette[1 + 256 * 3];
-
-	pcxPalette[0] = 12;
-	for (int i = 0; i < 256; i++) {
-		pcxPalette[1 + 3 * i + 0] = palette[i].r;
-		pcxPalette[1 + 3 * i + 1] = palette[i].g;
-		pcxPalette[1 + 3 * i + 2] = palette[i].b;
+	SDLSurfaceUniquePtr surface = SDLWrap::CreateRGBSurfaceWithFormatFrom(
+	    frame.pixels.get(), frame.width, frame.height, 8, frame.width, SDL_PIXELFORMAT_INDEX8);
+	if (SDLC_SetSurfaceColors(surface.get(), frame.palette.data(), 0, 256) <= -1) {
+		LogError("Failed to save {}: {}", frame.path, SDL_GetError());
+		return;
 	}
 
-	out->write(reinterpret_cast<const char *>(pcxPalette), sizeof(pcxPalette));
-	return !out->fail();
+#ifdef USE_SDL1
+	const bool success = SDL_SaveBMP(surface.get(), frame.path.c_str()) == 0;
+#else
+	const bool success = IMG_SavePNG(surface.get(), frame.path.c_str()) == 0;
+#endif
+	if (!success) {
+		LogError("Failed to save {}: {}", frame.path, SDL_GetError());
+		RemoveFile(frame.path.c_str());
+		return;
+	}
+	LogVerbose("Saved {}", frame.path);
 }
 
-/**
- * @brief RLE compress the pixel data
- * @param src Raw pixel buffer
- * @param dst Output buffer
- * @param width Width of pixel buffer
-
- * @return Output buffer
- */
-BYTE *CaptureEnc(BYTE *src, BYTE *dst, int width)
+void CaptureThreadHandler()
 {
-	int rleLength;
-
-	do {
-		BYTE rlePixel = *src;
-		src++;
-		rleLength = 1;
-
-		width--;
-
-		while (rlePixel == *src) {
-			if (rleLength >= 63)
-				break;
-			if (width == 0)
-				break;
-			rleLength++;
-
-			width--;
-			src++;
+	while (true) {
+		CapturedFrame frame;
+		while (CaptureQueue.TryPop(frame)) {
+			SaveFrame(frame);
+			frame.pixels = nullptr;
 		}
 
-		if (rleLength > 1 || rlePixel > 0xBF) {
-			*dst = rleLength | 0xC0;
-			dst++;
-		}
+		std::lock_guard<SdlMutex> lock(*CaptureMutex);
+		if (!CaptureThreadRunning)
+			return;
+		if (CaptureQueue.Empty())
+			WorkToDo->wait(*CaptureMutex);
+	}
+}
 
-		*dst = rlePixel;
-		dst++;
-	} while (width > 0);
+void WakeCaptureThread()
+{
+	std::lock_guard<SdlMutex> lock(*CaptureMutex);
+	WorkToDo->signal();
+}
 
-	return dst;
+void StartCaptureThread()
+{
+	if (CaptureThreadRunning)
+		return;
+
+#ifndef USE_SDL1
+	InitPNG();
+#endif
+	CaptureThreadRunning = true;
+	CaptureMutex.emplace();
+	WorkToDo.emplace();
+	Thread = SdlThread { CaptureThreadHandler };
 }
 
 /**
- * @brief Write the pixel data to the PCX file
- * @param buf Buffer
- * @return True if successful, else false
+ * @brief Copy the back buffer and the palette and queue them to be saved at the given path
+ * @param wait Wait for the encoder if the queue is full instead of dropping the frame
+ * @return false if the frame was dropped
  */
-bool CapturePix(const Surface &buf, std::ofstream *out)
+bool QueueFrame(std::string path, bool wait)
 {
-	int width = buf.w();
-	std::unique_ptr<BYTE[]> pBuffer { new BYTE[2 * width] };
-	BYTE *pixels = buf.begin();
-	for (int height = buf.h(); height > 0; height--) {
-		const BYTE *pBufferEnd = CaptureEnc(pixels, pBuffer.get(), width);
-		pixels += buf.pitch();
-		out->write(reinterpret_cast<const char *>(pBuffer.get()), pBufferEnd - pBuffer.get());
-		if (out->fail())
+	StartCaptureThread();
+
+	CapturedFrame frame;
+	frame.path = std::move(path);
+	PaletteGetEntries(256, frame.palette.data());
+
+	lock_buf(2);
+	const Surface &buf = GlobalBackBuffer();
+	frame.width = buf.w();
+	frame.height = buf.h();
+	frame.pixels.reset(new uint8_t[frame.width * frame.height]);
+	for (int y = 0; y < frame.height; y++)
+		std::memcpy(&frame.pixels[y * frame.width], buf.at(0, y), frame.width);
+	unlock_buf(2);
+
+	while (!CaptureQueue.TryPush(frame)) {
+		if (!wait)
 			return false;
+		WakeCaptureThread();
+		SDL_Delay(1);
 	}
+	WakeCaptureThread();
 	return true;
 }
 
-std::ofstream CaptureFile(std::string *dstPath)
+void EndFrameCapture()
+{
+	FramesToCapture = 0;
+	if (DroppedFrames > 0)
+		LogWarn("Dropped {} frames because the encoder fell behind", DroppedFrames);
+	DroppedFrames = 0;
+}
+
+} // namespace
+
+void CaptureScreen()
 {
-	char filename[sizeof("screen00.PCX") / sizeof(char)];
-	for (int i = 0; i <= 99; ++i) {
-		snprintf(filename, sizeof(filename) / sizeof(char), "screen%02d.PCX", i);
-		*dstPath = paths::PrefPath() + filename;
-		if (!FileExists(dstPath->c_str())) {
-			return std::ofstream(*dstPath, std::ios::binary | std::ios::trunc);
+	for (; NextScreenshot <= 99; NextScreenshot++) {
+		std::string path = fmt::format("{}screen{:02}.{}", paths::PrefPath(), NextScreenshot, CaptureExtension);
+		if (FileExists(path.c_str()))
+			continue;
+		NextScreenshot++;
+		DrawAndBlit();
+		// Only happens while a recording keeps the encoder busy
+		if (!QueueFrame(path, false)) {
+			LogError("Failed to save {}: the capture queue is full", path);
+			EventPlrMsg(_("Screenshot failed"));
+			return;
 		}
+		Log("Screenshot saved at {}", path);
+		EventPlrMsg(_("Screenshot saved"));
+		return;
 	}
-	return {};
 }
 
-/**
- * @brief Make a red version of the given palette and apply it to the screen.
- */
-void RedPalette()
+void StartFrameCapture(std::string directory, int frames, bool waitForEncoder)
 {
-	for (int i = 0; i < 256; i++) {
-		system_palette[i].g = 0;
-		system_palette[i].b = 0;
-	}
-	palette_update();
-	BltFast(nullptr, nullptr);
-	RenderPresent();
+	if (directory.empty())
+		directory = paths::PrefPath();
+	else if (directory.back() != '/' && directory.back() != '\\')
+		directory += '/';
+	FramePathPrefix = std::move(directory) + "frame";
+	FramesToCapture = frames;
+	WaitForEncoder = waitForEncoder;
+	DroppedFrames = 0;
 }
-} // namespace
 
-void CaptureScreen()
+void StopFrameCapture()
+{
+	if (FramesToCapture != 0)
+		EndFrameCapture();
+}
+
+bool IsCapturingFrames()
 {
-	SDL_Color palette[256];
-	std::string fileName;
-	bool success;
+	return FramesToCapture != 0;
+}
 
-	std::ofstream outStream = CaptureFile(&fileName);
-	if (!outStream.is_open())
+void CaptureFrame()
+{
+	if (FramesToCapture == 0)
 		return;
-	DrawAndBlit();
-	PaletteGetEntries(256, palette);
-	RedPalette();
+	// Dropped frames keep their number, so gaps in the file names show where they were
+	if (!QueueFrame(fmt::format("{}{:06}.{}", FramePathPrefix, CapturedFrames++, CaptureExtension), WaitForEncoder))
+		DroppedFrames++;
+	if (FramesToCapture > 0 && --FramesToCapture == 0)
+		EndFrameCapture();
+}
 
-	lock_buf(2);
-	const Surface &buf = GlobalBackBuffer();
-	success = CaptureHdr(buf.w(), buf.h(), &outStream);
-	if (success) {
-		success = CapturePix(buf, &outStream);
-	}
-	if (success) {
-		success = CapturePal(palette, &outStream);
-	}
-	unlock_buf(2);
-	outStream.close();
+void CaptureCleanup()
+{
+	StopFrameCapture();
+	if (!CaptureThreadRunning)
+		return;
 
-	if (!success) {
-		Log("Failed to save screenshot at {}", fileName);
-		RemoveFile(fileName.c_str());
-	} else {
-		Log("Screenshot saved at {}", fileName);
-	}
-	SDL_Delay(300);
-	for (int i = 0; i < 256; i++) {
-		system_palette[i] = palette[i];
+	// Let the capture thread save the queued frames before it stops
+	{
+		std::lock_guard<SdlMutex> lock(*CaptureMutex);
+		CaptureThreadRunning = false;
+		WorkToDo->signal();
 	}
-	palette_update();
-	force_redraw = 255;
+
+	Thread.join();
+	CaptureMutex = std::nullopt;
+	WorkToDo = std::nullopt;
 }
 
 } // namespace devilution
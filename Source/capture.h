@@ -5,11 +5,36 @@
  */
 #pragma once
 
+#include <string>
+
 namespace devilution {
 
 /**
- * @brief Save the current screen to a screen??.PCX (00-99) in file if available, then make the screen red for 200ms.
+ * @brief Save the current screen to a screen??.png (00-99) in the save folder if available.
+ *
+ * Only the back buffer and palette are copied on the game thread, the PNG is written by a background thread.
  */
 void CaptureScreen();
 
+/**
+ * @brief Save the following frames as numbered PNG files, for recording videos
+ * @param directory Folder to save the frames in, the save folder if empty
+ * @param frames Number of frames to save, -1 to keep saving until StopFrameCapture
+ * @param waitForEncoder Slow the game down to the speed of the encoder instead of dropping frames,
+ * for offline captures. Dropped frames are counted and logged when the capture ends.
+ */
+void StartFrameCapture(std::string directory, int frames, bool waitForEncoder);
+void StopFrameCapture();
+bool IsCapturingFrames();
+
+/**
+ * @brief Queue the back buffer if frames are being captured, called whenever a frame is presented
+ */
+void CaptureFrame();
+
+/**
+ * @brief Wait for the queued screenshots and frames to be written
+ */
+void CaptureCleanup();
+
 } // namespace devilution
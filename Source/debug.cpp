@@ -29,6 +29,7 @@
 #include "towners.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/memory_stats.hpp"
 
 namespace devilution {
 
@@ -734,6 +735,20 @@ std::string DebugCmdToggleFPS(const string_view parameter)
 	return "";
 }
 
+std::string DebugCmdToggleMemoryOverlay(const string_view parameter)
+{
+#ifdef MEMORY_ACCOUNTING
+	ShowMemoryOverlay = !ShowMemoryOverlay;
+	LogMemoryUsage();
+	size_t totalBytes = 0;
+	for (auto category : enum_values<MemoryCategory>())
+		totalBytes += GetMemoryUsage(category).currentBytes;
+	return fmt::format("Heap in use: {} KiB.", totalBytes / 1024);
+#else
+	return "Memory accounting requires a build with MEMORY_ACCOUNTING.";
+#endif
+}
+
 std::vector<DebugCmdItem> DebugCmdList = {
 	{ "help", "Prints help overview or help for a specific command.", "({command})", &DebugCmdHelp },
 	{ "give gold", "Fills the inventory with gold.", "", &DebugCmdGiveGoldCheat },
@@ -765,6 +780,7 @@ std::vector<DebugCmdItem> DebugCmdList = {
 	{ "questinfo", "Shows info of quests.", "{id}", &DebugCmdQuestInfo },
 	{ "playerinfo", "Shows info of player.", "{playerid}", &DebugCmdPlayerInfo },
 	{ "fps", "Toggles displaying FPS", "", &DebugCmdToggleFPS },
+	{ "memory", "Toggles displaying the heap usage of each subsystem.", "", &DebugCmdToggleMemoryOverlay },
 };
 
 } // namespace
@@ -36,6 +36,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
+#include "engine/tick_stats.hpp"
 #include "error.h"
 #include "gamemenu.h"
 #include "gmenu.h"
@@ -69,8 +70,11 @@
 #include "track.h"
 #include "trigs.h"
 #include "utils/console.h"
+#include "utils/display.h"
 #include "utils/language.h"
+#include "utils/memory_stats.hpp"
 #include "utils/paths.h"
+#include "utils/profiler.hpp"
 #include "utils/stdcompat/string_view.hpp"
 #include "utils/utf8.hpp"
 
@@ -404,8 +408,14 @@ bool PressSysKey(int wParam)
 
 void ReleaseKey(int vkey)
 {
-	if (vkey == DVL_VK_SNAPSHOT)
-		CaptureScreen();
+	if (vkey == DVL_VK_SNAPSHOT) {
+		if ((SDL_GetModState() & KMOD_SHIFT) == 0)
+			CaptureScreen();
+		else if (IsCapturingFrames())
+			StopFrameCapture();
+		else
+			StartFrameCapture({}, -1, false);
+	}
 	if (vkey == DVL_VK_MENU || vkey == DVL_VK_LMENU || vkey == DVL_VK_RMENU)
 		AltPressed(false);
 	if (vkey == DVL_VK_RCONTROL)
@@ -752,7 +762,11 @@ void RunGameLoop(interface_mode uMsg)
 		diablo_color_cyc_logic();
 		multi_process_network_packets();
 		game_loop(gbGameLoopStartup);
+		if (demo::IsRunning() || demo::IsRecording())
+			demo::NotifyGameLogicEnd();
 		gbGameLoopStartup = false;
+		if (nthread_is_fast_forward())
+			drawGame = nthread_fast_forward_tick();
 		if (drawGame)
 			DrawAndBlit();
 #ifdef GPERF_HEAP_FIRST_GAME_ITERATION
@@ -794,8 +808,18 @@ void RunGameLoop(interface_mode uMsg)
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "-f", _("Display frames per second"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--verbose", _("Enable verbose logging"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--record <#>", _("Record a demo file"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--state-hashes", _("Store checksums of the game state in the recorded demo"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--demo <#>", _("Play a demo file"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--timedemo", _("Disable all frame limiting during demo playback"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--timedemo-report <file>", _("Write the timing of each game logic step and frame of the demo to a JSON or CSV file"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--headless", _("Play the demo without a window or sound device"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--fast-forward <#>", _("Run single player game ticks as fast as possible without sound, drawing every #th tick (0 for none)"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--offscreen", _("Render to memory only, without a window or sound device"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--dump-frames <dir>", _("Save every frame as a PNG file in the folder, the game waits for the encoder"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--profile <file>", _("Show the time spent in each part of a frame and write a Chrome trace to the file"));
+#ifdef TICK_STATS
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--tick-stats <file>", _("Count the game logic steps, time a sample of the game ticks and write the statistics to the file every 10 seconds"));
+#endif
 	printInConsole("%s", _(/* TRANSLATORS: Commandline Option */ "\nGame selection:\n"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--spawn", _("Force Shareware mode"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--diablo", _("Force Diablo mode"));
@@ -818,6 +842,10 @@ void DiabloParseFlags(int argc, char **argv)
 	std::string currentCommand;
 #endif
 	bool timedemo = false;
+	bool headless = false;
+	bool stateHashes = false;
+	bool fastForward = false;
+	std::string timedemoReport;
 	int demoNumber = -1;
 	int recordNumber = -1;
 	for (int i = 1; i < argc; i++) {
@@ -854,12 +882,51 @@ void DiabloParseFlags(int argc, char **argv)
 			gbShowIntro = false;
 		} else if (arg == "--timedemo") {
 			timedemo = true;
+		} else if (arg == "--timedemo-report") {
+			if (i + 1 == argc) {
+				printInConsole("%s requires an argument\n", "--timedemo-report");
+				diablo_quit(0);
+			}
+			timedemoReport = argv[++i];
+		} else if (arg == "--headless") {
+			headless = true;
+		} else if (arg == "--fast-forward") {
+			if (i + 1 == argc) {
+				printInConsole("%s requires an argument\n", "--fast-forward");
+				diablo_quit(0);
+			}
+			nthread_init_fast_forward(SDL_atoi(argv[++i]));
+			fastForward = true;
+		} else if (arg == "--offscreen") {
+			InitOffscreenRendering();
+		} else if (arg == "--dump-frames") {
+			if (i + 1 == argc) {
+				printInConsole("%s requires an argument\n", "--dump-frames");
+				diablo_quit(0);
+			}
+			StartFrameCapture(argv[++i], -1, true);
 		} else if (arg == "--record") {
 			if (i + 1 == argc) {
 				printInConsole("%s requires an argument\n", "--record");
 				diablo_quit(0);
 			}
 			recordNumber = SDL_atoi(argv[++i]);
+		} else if (arg == "--state-hashes") {
+			stateHashes = true;
+		} else if (arg == "--profile") {
+			if (i + 1 == argc) {
+				printInConsole("%s requires an argument\n", "--profile");
+				diablo_quit(0);
+			}
+			profiler::Init(argv[++i]);
+#ifdef TICK_STATS
+		} else if (arg == "--tick-stats") {
+			if (i + 1 == argc) {
+				printInConsole("%s requires an argument\n", "--tick-stats");
+				diablo_quit(0);
+			}
+			tick_stats::Init(argv[++i]);
+#endif
 		} else if (arg == "-n") {
 			gbShowIntro = false;
 		} else if (arg == "-f") {
@@ -900,10 +967,20 @@ void DiabloParseFlags(int argc, char **argv)
 		DebugCmdsFromCommandLine.push_back(currentCommand);
 #endif
 
+	if ((headless || !timedemoReport.empty()) && demoNumber == -1) {
+		printInConsole("%s\n", "--headless and --timedemo-report require --demo");
+		diablo_quit(0);
+	}
+	if (stateHashes && recordNumber == -1) {
+		printInConsole("%s\n", "--state-hashes requires --record");
+		diablo_quit(0);
+	}
+	if (!timedemoReport.empty())
+		demo::InitTimingReport(timedemoReport);
 	if (demoNumber != -1)
-		demo::InitPlayBack(demoNumber, timedemo);
+		demo::InitPlayBack(demoNumber, timedemo || fastForward, headless);
 	if (recordNumber != -1)
-		demo::InitRecording(recordNumber);
+		demo::InitRecording(recordNumber, stateHashes);
 }
 
 void DiabloInitScreen()
@@ -975,7 +1052,9 @@ void DiabloInit()
 
 	DiabloInitScreen();
 
-	snd_init();
+	// Fast forwarding runs silently, as if no sound device was available
+	if (!nthread_is_fast_forward())
+		snd_init();
 	was_snd_init = true;
 
 	ui_sound_init();
@@ -1010,6 +1089,10 @@ void DiabloSplash()
 void DiabloDeinit()
 {
 	FreeItemGFX();
+	profiler::Shutdown();
+	tick_stats::Shutdown();
+	CaptureCleanup();
+	LogMemoryUsage();
 
 	if (sbWasOptionsLoaded && !demo::IsRunning())
 		SaveOptions();
@@ -1030,6 +1113,7 @@ void DiabloDeinit()
 void LoadLvlGFX()
 {
 	assert(pDungeonCels == nullptr);
+	MemoryCategoryScope memoryScope(MemoryCategory::Dungeon);
 	constexpr int SpecialCelWidth = 64;
 
 	switch (leveltype) {
@@ -1188,35 +1272,45 @@ void UpdateMonsterLights()
 	}
 }
 
+void SetGameLogicStep(GameLogicStep step)
+{
+	tick_stats::EnterStep(step);
+	gGameLogicStep = step;
+	if (demo::IsTiming())
+		demo::TimeGameLogicStep(step);
+}
+
 void GameLogic()
 {
+	DVL_PROFILE_ZONE("GameLogic");
 	if (!ProcessInput()) {
 		return;
 	}
 	if (gbProcessPlayers) {
-		gGameLogicStep = GameLogicStep::ProcessPlayers;
+		SetGameLogicStep(GameLogicStep::ProcessPlayers);
 		ProcessPlayers();
 	}
 	if (leveltype != DTYPE_TOWN) {
-		gGameLogicStep = GameLogicStep::ProcessMonsters;
+		SetGameLogicStep(GameLogicStep::ProcessMonsters);
 		ProcessMonsters();
-		gGameLogicStep = GameLogicStep::ProcessObjects;
+		SetGameLogicStep(GameLogicStep::ProcessObjects);
 		ProcessObjects();
-		gGameLogicStep = GameLogicStep::ProcessMissiles;
+		SetGameLogicStep(GameLogicStep::ProcessMissiles);
 		ProcessMissiles();
-		gGameLogicStep = GameLogicStep::ProcessItems;
+		SetGameLogicStep(GameLogicStep::ProcessItems);
 		ProcessItems();
+		SetGameLogicStep(GameLogicStep::ProcessLighting);
 		ProcessLightList();
 		ProcessVisionList();
 	} else {
-		gGameLogicStep = GameLogicStep::ProcessTowners;
+		SetGameLogicStep(GameLogicStep::ProcessTowners);
 		ProcessTowners();
-		gGameLogicStep = GameLogicStep::ProcessItemsTown;
+		SetGameLogicStep(GameLogicStep::ProcessItemsTown);
 		ProcessItems();
-		gGameLogicStep = GameLogicStep::ProcessMissilesTown;
+		SetGameLogicStep(GameLogicStep::ProcessMissilesTown);
 		ProcessMissiles();
 	}
-	gGameLogicStep = GameLogicStep::None;
+	SetGameLogicStep(GameLogicStep::None);
 
 #ifdef _DEBUG
 	if (DebugScrollViewEnabled && GetAsyncKeyState(DVL_VK_SHIFT)) {
@@ -1640,7 +1734,7 @@ int DiabloMain(int argc, char **argv)
 	mainmenu_loop();
 	DiabloDeinit();
 
-	return 0;
+	return demo::StateHashesDiverged() ? 1 : 0;
 }
 
 bool TryIconCurs()
@@ -1861,6 +1955,7 @@ void DisableInputWndProc(uint32_t uMsg, int32_t /*wParam*/, int32_t lParam)
 
 void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 {
+	DVL_PROFILE_ZONE("LoadGameLevel");
 	music_stop();
 	if (pcurs > CURSOR_HAND && pcurs < CURSOR_FIRSTITEM) {
 		NewCursor(CURSOR_HAND);
@@ -2119,6 +2214,8 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	pcursitem = -1;
 	pcursinvitem = -1;
 	pcursplr = -1;
+
+	LogMemoryUsage();
 }
 
 void game_loop(bool bStartup)
@@ -2131,13 +2228,48 @@ void game_loop(bool bStartup)
 			break;
 		}
 		TimeoutCursor(false);
-		GameLogic();
+		tick_stats::TickStart();
+		if (demo::IsTiming()) {
+			demo::TimeTickStart();
+			GameLogic();
+			demo::TimeTickEnd();
+		} else {
+			GameLogic();
+		}
+		tick_stats::TickEnd();
 
 		if (!gbRunGame || !gbIsMultiplayer || demo::IsRunning() || demo::IsRecording() || !nthread_has_500ms_passed())
 			break;
 	}
 }
 
+const char *GameLogicStepName(GameLogicStep step)
+{
+	switch (step) {
+	case GameLogicStep::None:
+		return "Other";
+	case GameLogicStep::ProcessPlayers:
+		return "ProcessPlayers";
+	case GameLogicStep::ProcessMonsters:
+		return "ProcessMonsters";
+	case GameLogicStep::ProcessObjects:
+		return "ProcessObjects";
+	case GameLogicStep::ProcessMissiles:
+		return "ProcessMissiles";
+	case GameLogicStep::ProcessItems:
+		return "ProcessItems";
+	case GameLogicStep::ProcessLighting:
+		return "ProcessLighting";
+	case GameLogicStep::ProcessTowners:
+		return "ProcessTowners";
+	case GameLogicStep::ProcessItemsTown:
+		return "ProcessItemsTown";
+	case GameLogicStep::ProcessMissilesTown:
+		return "ProcessMissilesTown";
+	}
+	return "Unknown";
+}
+
 void diablo_color_cyc_logic()
 {
 	if (!*sgOptions.Graphics.colorCycling)
@@ -37,11 +37,14 @@ enum class GameLogicStep {
 	ProcessObjects,
 	ProcessMissiles,
 	ProcessItems,
+	ProcessLighting,
 	ProcessTowners,
 	ProcessItemsTown,
 	ProcessMissilesTown,
 };
 
+constexpr size_t NumGameLogicSteps = static_cast<size_t>(GameLogicStep::ProcessMissilesTown) + 1;
+
 enum class MouseActionType : int {
 	None,
 	Walk,
@@ -98,6 +101,7 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir);
  */
 void game_loop(bool bStartup);
 void diablo_color_cyc_logic();
+const char *GameLogicStepName(GameLogicStep step);
 
 /* rdata */
 
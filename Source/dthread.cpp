@@ -4,12 +4,14 @@
  * Implementation of functions for updating game state from network commands.
  */
 
-#include <list>
+#include <atomic>
+#include <deque>
 #include <mutex>
 
 #include "nthread.h"
 #include "utils/sdl_cond.h"
 #include "utils/sdl_thread.h"
+#include "utils/spsc_queue.hpp"
 
 namespace devilution {
 
@@ -18,63 +20,113 @@ struct DThreadPkt {
 	_cmd_id cmd;
 	std::unique_ptr<byte[]> data;
 	uint32_t len;
-
-	DThreadPkt(int pnum, _cmd_id(cmd), std::unique_ptr<byte[]> data, uint32_t len)
-	    : pnum(pnum)
-	    , cmd(cmd)
-	    , data(std::move(data))
-	    , len(len)
-	{
-	}
+	/** Value of PlayerGeneration[pnum] when the packet was queued */
+	uint32_t generation;
 };
 
 namespace {
 
+/** Packets queued for one joining player: the player info, every level, the junk and the end marker */
+constexpr size_t MaxPacketsPerJoin = 1 + NUMLEVELS + 2;
+
+/**
+ * Packets are queued by the game thread and sent by the delta thread. The queue holds the
+ * complete level data for every player joining at the same time.
+ */
+SpscQueue<DThreadPkt, 128> InfoQueue;
+static_assert(MAX_PLRS * MaxPacketsPerJoin <= 128, "InfoQueue must hold the level data for all joining players");
+/**
+ * Packets that didn't fit in InfoQueue, only used if players rejoin faster than the delta thread
+ * sends. Guarded by DthreadMutex. While it isn't empty new packets go here too, to keep them in order.
+ */
+std::deque<DThreadPkt> Overflow;
+/** Set by the game thread when it adds to Overflow, cleared by the delta thread when it takes them */
+std::atomic<bool> OverflowPending;
+/** Set while the delta thread waits for work, so the game thread only locks to wake it up */
+std::atomic<bool> DthreadSleeping;
+/** Incremented when a player leaves, so that packets queued for them are dropped */
+std::atomic<uint32_t> PlayerGeneration[MAX_PLRS];
+std::atomic<bool> DthreadRunning;
+/** Lets the delta thread sleep while there is no work and guards Overflow */
 std::optional<SdlMutex> DthreadMutex;
-std::list<DThreadPkt> InfoList;
-bool DthreadRunning;
 std::optional<SdlCond> WorkToDo;
 
 /* rdata */
 SdlThread Thread;
 
+void SendPacket(DThreadPkt &pkt)
+{
+	if (DthreadRunning && pkt.generation == PlayerGeneration[pkt.pnum])
+		multi_send_zero_packet(pkt.pnum, pkt.cmd, pkt.data.get(), pkt.len);
+	pkt.data = nullptr;
+}
+
 void DthreadHandler()
 {
-	std::lock_guard<SdlMutex> lock(*DthreadMutex);
+	std::deque<DThreadPkt> overflow;
 	while (true) {
-		while (!InfoList.empty()) {
-			DThreadPkt pkt = std::move(InfoList.front());
-			InfoList.pop_front();
-
-			DthreadMutex->unlock();
-			multi_send_zero_packet(pkt.pnum, pkt.cmd, pkt.data.get(), pkt.len);
-			DthreadMutex->lock();
+		DThreadPkt pkt;
+		while (InfoQueue.TryPop(pkt))
+			SendPacket(pkt);
+
+		{
+			std::lock_guard<SdlMutex> lock(*DthreadMutex);
+			if (!DthreadRunning) {
+				Overflow.clear();
+				OverflowPending.store(false, std::memory_order_relaxed);
+				return;
+			}
+			overflow.swap(Overflow);
+			OverflowPending.store(false, std::memory_order_release);
+			if (overflow.empty()) {
+				// Pairs with the fence in dthread_send_delta: either the game thread sees that we sleep
+				// or we see its packet
+				DthreadSleeping.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (InfoQueue.Empty())
+					WorkToDo->wait(*DthreadMutex);
+				DthreadSleeping.store(false, std::memory_order_relaxed);
+				continue;
+			}
 		}
-		if (!DthreadRunning)
-			return;
-		WorkToDo->wait(*DthreadMutex);
+
+		// The overflow was queued after everything above and before anything the game thread
+		// pushes to InfoQueue from now on
+		for (DThreadPkt &overflowPkt : overflow)
+			SendPacket(overflowPkt);
+		overflow.clear();
 	}
 }
 
+void WakeDthread()
+{
+	std::lock_guard<SdlMutex> lock(*DthreadMutex);
+	WorkToDo->signal();
+}
+
 } // namespace
 
 void dthread_remove_player(uint8_t pnum)
 {
-	std::lock_guard<SdlMutex> lock(*DthreadMutex);
-	InfoList.remove_if([&](auto &pkt) {
-		return pkt.pnum == pnum;
-	});
+	PlayerGeneration[pnum]++;
 }
 
 void dthread_send_delta(int pnum, _cmd_id cmd, std::unique_ptr<byte[]> data, uint32_t len)
 {
-	if (!gbIsMultiplayer)
+	if (!gbIsMultiplayer || !DthreadRunning)
 		return;
 
-	DThreadPkt pkt { pnum, cmd, std::move(data), len };
+	DThreadPkt pkt { pnum, cmd, std::move(data), len, PlayerGeneration[pnum] };
+	if (!OverflowPending.load(std::memory_order_acquire) && InfoQueue.TryPush(pkt)) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (DthreadSleeping.load(std::memory_order_relaxed))
+			WakeDthread();
+		return;
+	}
 
 	std::lock_guard<SdlMutex> lock(*DthreadMutex);
-	InfoList.push_back(std::move(pkt));
+	Overflow.push_back(std::move(pkt));
+	OverflowPending.store(true, std::memory_order_relaxed);
 	WorkToDo->signal();
 }
 
@@ -94,12 +146,9 @@ void DThreadCleanup()
 	if (!DthreadRunning)
 		return;
 
-	{
-		std::lock_guard<SdlMutex> lock(*DthreadMutex);
-		DthreadRunning = false;
-		InfoList.clear();
-		WorkToDo->signal();
-	}
+	// The delta thread drops whatever is still queued
+	DthreadRunning = false;
+	WakeDthread();
 
 	Thread.join();
 	DthreadMutex = std::nullopt;
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
 
 namespace devilution {
 namespace net {
@@ -80,6 +81,9 @@ void base::RecvLocal(packet &pkt)
 	case PT_TURN:
 		turn_queue[pkt.Source()].push_back(pkt.Turn());
 		break;
+	case PT_BUNDLE:
+		pktfty->for_each_bundled(pkt, [this](packet &bundled) { RecvLocal(bundled); });
+		break;
 	case PT_JOIN_ACCEPT:
 		HandleAccept(pkt);
 		break;
@@ -111,12 +115,24 @@ void base::RecvLocal(packet &pkt)
 	}
 }
 
+void base::FlushBundle()
+{
+#ifdef PACKET_BUNDLING
+	if (bundle_pending.empty())
+		return;
+	auto pkt = pktfty->make_packet<PT_BUNDLE>(plr_self, bundle_dest, std::move(bundle_pending));
+	bundle_pending.clear();
+	send(std::move(pkt));
+#endif
+}
+
 bool base::SNetReceiveMessage(int *sender, void **data, uint32_t *size)
 {
+	FlushBundle();
 	poll();
 	if (message_queue.empty())
 		return false;
-	message_last = message_queue.front();
+	message_last = std::move(message_queue.front());
 	message_queue.pop_front();
 	*sender = message_last.sender;
 	*size = message_last.payload.size();
@@ -131,22 +147,24 @@ bool base::SNetSendMessage(int playerId, void *data, unsigned int size)
 		abort();
 	auto *rawMessage = reinterpret_cast<unsigned char *>(data);
 	buffer_t message(rawMessage, rawMessage + size);
-	if (playerId == plr_self || playerId == SNPLAYER_ALL)
-		message_queue.emplace_back(plr_self, message);
 	plr_t dest;
 	if (playerId == SNPLAYER_ALL || playerId == SNPLAYER_OTHERS)
 		dest = PLR_BROADCAST;
 	else
 		dest = playerId;
 	if (dest != plr_self) {
-		auto pkt = pktfty->make_packet<PT_MESSAGE>(plr_self, dest, message);
-		send(*pkt);
+		if (playerId == SNPLAYER_ALL)
+			message_queue.emplace_back(plr_self, message);
+		SendInGame<PT_MESSAGE>(dest, std::move(message));
+	} else {
+		message_queue.emplace_back(plr_self, std::move(message));
 	}
 	return true;
 }
 
 bool base::SNetReceiveTurns(char **data, size_t *size, uint32_t *status)
 {
+	FlushBundle();
 	poll();
 	bool allTurnsArrived = true;
 	for (auto i = 0; i < MAX_PLRS; ++i) {
@@ -186,9 +204,10 @@ bool base::SNetSendTurn(char *data, unsigned int size)
 		ABORT();
 	turn_t turn;
 	std::memcpy(&turn, data, sizeof(turn));
-	auto pkt = pktfty->make_packet<PT_TURN>(plr_self, PLR_BROADCAST, turn);
-	send(*pkt);
-	turn_queue[plr_self].push_back(pkt->Turn());
+	SendInGame<PT_TURN>(PLR_BROADCAST, turn);
+	// The turn closes the game tick, so send everything queued for it
+	FlushBundle();
+	turn_queue[plr_self].push_back(turn);
 	return true;
 }
 
@@ -228,19 +247,20 @@ bool base::SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func)
 
 bool base::SNetLeaveGame(int type)
 {
-	auto pkt = pktfty->make_packet<PT_DISCONNECT>(plr_self, PLR_BROADCAST,
-	    plr_self, type);
-	send(*pkt);
+	FlushBundle();
+	send(pktfty->make_packet<PT_DISCONNECT>(plr_self, PLR_BROADCAST,
+	    plr_self, type));
 	return true;
 }
 
 bool base::SNetDropPlayer(int playerid, uint32_t flags)
 {
-	auto pkt = pktfty->make_packet<PT_DISCONNECT>(plr_self,
+	FlushBundle();
+	std::shared_ptr<packet> pkt = pktfty->make_packet<PT_DISCONNECT>(plr_self,
 	    PLR_BROADCAST,
 	    (plr_t)playerid,
 	    (leaveinfo_t)flags);
-	send(*pkt);
+	send(pkt);
 	RecvLocal(*pkt);
 	return true;
 }
@@ -5,6 +5,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "dvlnet/abstract_net.h"
 #include "dvlnet/packet.h"
@@ -33,7 +34,7 @@ public:
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns);
 
 	virtual void poll() = 0;
-	virtual void send(packet &pkt) = 0;
+	virtual void send(std::shared_ptr<packet> pkt) = 0;
 	virtual void DisconnectNet(plr_t plr);
 
 	void setup_gameinfo(buffer_t info);
@@ -57,7 +58,7 @@ protected:
 		}
 		message_t(int s, buffer_t p)
 		    : sender(s)
-		    , payload(p)
+		    , payload(std::move(p))
 		{
 		}
 	};
@@ -77,10 +78,47 @@ protected:
 	void RecvLocal(packet &pkt);
 	void RunEventHandler(_SNETEVENT &ev);
 
+	/**
+	 * @brief Send the PT_BUNDLE holding the in-game packets queued since the last flush
+	 */
+	void FlushBundle();
+
 private:
+#ifdef PACKET_BUNDLING
+	/** Payload of the PT_BUNDLE that is being assembled */
+	buffer_t bundle_pending;
+	plr_t bundle_dest = PLR_BROADCAST;
+#endif
+
 	plr_t GetOwner();
 	void ClearMsg(plr_t plr);
+
+	template <packet_type t, typename... Args>
+	void SendInGame(plr_t dest, Args... args);
 };
 
+/**
+ * @brief Send a PT_MESSAGE or PT_TURN packet
+ *
+ * With PACKET_BUNDLING the packet is queued and goes out with every other packet
+ * for the same destination in one PT_BUNDLE, which is encrypted once.
+ */
+template <packet_type t, typename... Args>
+void base::SendInGame(plr_t dest, Args... args)
+{
+#ifdef PACKET_BUNDLING
+	// Leave room for the bundle header and the encryption overhead
+	constexpr size_t MaxBundleSize = packet_factory::max_packet_size - 128;
+
+	auto pkt = pktfty->make_plain_packet<t>(plr_self, dest, std::move(args)...);
+	if (dest != bundle_dest || bundle_pending.size() + sizeof(uint16_t) + pkt->Data().size() > MaxBundleSize)
+		FlushBundle();
+	bundle_dest = dest;
+	packet_factory::append_bundled(bundle_pending, pkt->Data());
+#else
+	send(pktfty->make_packet<t>(plr_self, dest, std::move(args)...));
+#endif
+}
+
 } // namespace net
 } // namespace devilution
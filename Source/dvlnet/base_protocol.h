@@ -19,7 +19,7 @@ public:
 	virtual int create(std::string addrstr);
 	virtual int join(std::string addrstr);
 	virtual void poll();
-	virtual void send(packet &pkt);
+	virtual void send(std::shared_ptr<packet> pkt);
 	virtual void DisconnectNet(plr_t plr);
 
 	virtual bool SNetLeaveGame(int type);
@@ -151,18 +151,18 @@ void base_protocol<P>::poll()
 }
 
 template <class P>
-void base_protocol<P>::send(packet &pkt)
+void base_protocol<P>::send(std::shared_ptr<packet> pkt)
 {
-	if (pkt.Destination() < MAX_PLRS) {
-		if (pkt.Destination() == MyPlayerId)
+	if (pkt->Destination() < MAX_PLRS) {
+		if (pkt->Destination() == plr_self)
 			return;
-		if (peers[pkt.Destination()])
-			proto.send(peers[pkt.Destination()], pkt.Data());
-	} else if (pkt.Destination() == PLR_BROADCAST) {
+		if (peers[pkt->Destination()])
+			proto.send(peers[pkt->Destination()], pkt->Data());
+	} else if (pkt->Destination() == PLR_BROADCAST) {
 		for (auto &peer : peers)
 			if (peer)
-				proto.send(peer, pkt.Data());
-	} else if (pkt.Destination() == PLR_MASTER) {
+				proto.send(peer, pkt->Data());
+	} else if (pkt->Destination() == PLR_MASTER) {
 		throw dvlnet_exception();
 	} else {
 		throw dvlnet_exception();
@@ -1,5 +1,6 @@
 #include "dvlnet/frame_queue.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "dvlnet/packet.h"
@@ -9,37 +10,57 @@ namespace net {
 
 framesize_t frame_queue::Size() const
 {
-	return current_size;
+	return write_pos - read_pos;
 }
 
 buffer_t frame_queue::Read(framesize_t s)
 {
-	if (current_size < s)
+	if (Size() < s)
 		throw frame_queue_exception();
-	buffer_t ret;
-	while (s > 0 && s >= buffer_deque.front().size()) {
-		s -= buffer_deque.front().size();
-		current_size -= buffer_deque.front().size();
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().end());
-		buffer_deque.pop_front();
-	}
-	if (s > 0) {
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		buffer_deque.front().erase(buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		current_size -= s;
+	const unsigned char *begin = &storage[read_pos];
+	buffer_t ret(begin, begin + s);
+	read_pos += s;
+	if (read_pos == write_pos) {
+		read_pos = 0;
+		write_pos = 0;
 	}
 	return ret;
 }
 
-void frame_queue::Write(buffer_t buf)
+unsigned char *frame_queue::Prepare(std::size_t size)
+{
+	if (capacity - write_pos < size) {
+		std::size_t used = Size();
+		if (capacity - used >= size) {
+			// Enough room once the unread bytes are moved to the front
+			std::memmove(&storage[0], &storage[read_pos], used);
+		} else {
+			std::size_t newCapacity = std::max(capacity * 2, used + size);
+			std::unique_ptr<unsigned char[]> newStorage { new unsigned char[newCapacity] };
+			if (used > 0)
+				std::memcpy(&newStorage[0], &storage[read_pos], used);
+			storage = std::move(newStorage);
+			capacity = newCapacity;
+		}
+		read_pos = 0;
+		write_pos = used;
+	}
+	return &storage[write_pos];
+}
+
+void frame_queue::Commit(std::size_t size)
 {
-	current_size += buf.size();
-	buffer_deque.push_back(std::move(buf));
+	if (capacity - write_pos < size)
+		ABORT();
+	write_pos += size;
+}
+
+void frame_queue::Write(const buffer_t &buf)
+{
+	if (buf.empty())
+		return;
+	std::memcpy(Prepare(buf.size()), buf.data(), buf.size());
+	Commit(buf.size());
 }
 
 bool frame_queue::PacketReady()
@@ -47,8 +68,8 @@ bool frame_queue::PacketReady()
 	if (nextsize == 0) {
 		if (Size() < sizeof(framesize_t))
 			return false;
-		auto szbuf = Read(sizeof(framesize_t));
-		std::memcpy(&nextsize, &szbuf[0], sizeof(framesize_t));
+		std::memcpy(&nextsize, &storage[read_pos], sizeof(framesize_t));
+		read_pos += sizeof(framesize_t);
 		if (nextsize == 0)
 			throw frame_queue_exception();
 	}
@@ -64,12 +85,18 @@ buffer_t frame_queue::ReadPacket()
 	return ret;
 }
 
-buffer_t frame_queue::MakeFrame(buffer_t packetbuf)
+framesize_t frame_queue::FrameSize(const buffer_t &packetbuf)
 {
-	buffer_t ret;
 	if (packetbuf.size() > max_frame_size)
 		ABORT();
-	framesize_t size = packetbuf.size();
+	return static_cast<framesize_t>(packetbuf.size());
+}
+
+buffer_t frame_queue::MakeFrame(const buffer_t &packetbuf)
+{
+	buffer_t ret;
+	framesize_t size = FrameSize(packetbuf);
+	ret.reserve(sizeof(framesize_t) + size);
 	ret.insert(ret.end(), packet_out::begin(size), packet_out::end(size));
 	ret.insert(ret.end(), packetbuf.begin(), packetbuf.end());
 	return ret;
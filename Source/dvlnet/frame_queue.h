@@ -1,8 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <exception>
+#include <memory>
 #include <vector>
 
 namespace devilution {
@@ -20,13 +21,23 @@ public:
 
 typedef uint32_t framesize_t;
 
+/**
+ * @brief Splits a byte stream in to size prefixed frames
+ *
+ * Received bytes are kept in one contiguous buffer. Sockets receive directly in to it (see Prepare/Commit)
+ * and frames are only copied out once, when a complete packet is read.
+ */
 class frame_queue {
 public:
 	constexpr static framesize_t max_frame_size = 0xFFFF;
 
 private:
-	framesize_t current_size = 0;
-	std::deque<buffer_t> buffer_deque;
+	std::unique_ptr<unsigned char[]> storage;
+	std::size_t capacity = 0;
+	/** Offset of the first unread byte */
+	std::size_t read_pos = 0;
+	/** Offset one past the last received byte */
+	std::size_t write_pos = 0;
 	framesize_t nextsize = 0;
 
 	framesize_t Size() const;
@@ -35,9 +46,22 @@ private:
 public:
 	bool PacketReady();
 	buffer_t ReadPacket();
-	void Write(buffer_t buf);
+	void Write(const buffer_t &buf);
 
-	static buffer_t MakeFrame(buffer_t packetbuf);
+	/**
+	 * @brief Returns a buffer of at least the given size to receive data in to
+	 *
+	 * The pointer stays valid until the next call to any other member function. Use Commit to append
+	 * the bytes that were actually received.
+	 */
+	unsigned char *Prepare(std::size_t size);
+	void Commit(std::size_t size);
+
+	/**
+	 * @brief Returns the size header to send in front of the given packet
+	 */
+	static framesize_t FrameSize(const buffer_t &packetbuf);
+	static buffer_t MakeFrame(const buffer_t &packetbuf);
 };
 
 } // namespace net
@@ -0,0 +1,365 @@
+/**
+ * @file dvlnet/netbench_main.cpp
+ *
+ * Runs several virtual players in one process over a simulated network and reports turn latency
+ * and traffic, for tuning the tick rate and the network update rate.
+ */
+// The benchmark has its own entry point and never initializes SDL
+#define SDL_MAIN_HANDLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "dvlnet/base_protocol.h"
+#include "dvlnet/protocol_sim.h"
+#include "utils/stdcompat/string_view.hpp"
+
+namespace devilution {
+namespace net {
+namespace {
+
+struct BenchOptions {
+	int players = 4;
+	int seconds = 10;
+	sim_conditions conditions;
+	/** Game ticks per second, gnTickDelay is derived from it */
+	int tickRate = 20;
+	/** Game ticks per network turn, same as sgbNetUpdateRate */
+	int updateRate = 2;
+	/** Same as gdwTurnsInTransit */
+	int turnsInTransit = 1;
+	/** Size of the game message each player broadcasts per tick */
+	int messageSize = 64;
+	bool hasPassword = false;
+	std::string password;
+};
+
+struct VirtualPlayer {
+	std::unique_ptr<base_protocol<protocol_sim>> net;
+	std::thread thread;
+	/** Time from sending a turn until another player consumed it, in microseconds */
+	std::vector<uint64_t> turnLatencies;
+	uint64_t stalledUs = 0;
+	/** Time spent in the game loop, excluding the join */
+	uint64_t gameUs = 0;
+};
+
+struct Bench {
+	const BenchOptions &options;
+	std::vector<VirtualPlayer> players;
+	/** Time each turn was sent, indexed by player and turn */
+	std::vector<std::vector<uint64_t>> turnSentAt;
+	std::atomic<int> joined { 0 };
+	std::atomic<int> ready { 0 };
+	/** Set when a player gives up, so the others stop waiting for it */
+	std::atomic<bool> failed { false };
+	int ticks;
+	int turns;
+
+	explicit Bench(const BenchOptions &options)
+	    : options(options)
+	    , players(options.players)
+	    , turnSentAt(options.players)
+	{
+		ticks = options.seconds * options.tickRate;
+		turns = ticks / options.updateRate;
+		for (auto &sentAt : turnSentAt)
+			sentAt.resize(turns + options.turnsInTransit + 1);
+	}
+};
+
+uint64_t NowUs()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+void SleepUntilUs(uint64_t time)
+{
+	uint64_t now = NowUs();
+	if (time > now)
+		std::this_thread::sleep_for(std::chrono::microseconds(time - now));
+}
+
+[[noreturn]] void PrintHelpAndExit(int status)
+{
+	std::printf("Usage: devilutionx-netbench [options]\n\n");
+	std::printf("    %-24s %s\n", "-h, --help", "Print this message and exit");
+	std::printf("    %-24s %s\n", "--version", "Print the version and exit");
+	std::printf("    %-24s %s\n", "--players <#>", "Number of virtual players (default 4)");
+	std::printf("    %-24s %s\n", "--seconds <#>", "Length of the simulated game (default 10)");
+	std::printf("    %-24s %s\n", "--latency <ms>", "One way latency (default 0)");
+	std::printf("    %-24s %s\n", "--jitter <ms>", "Maximum random extra latency (default 0)");
+	std::printf("    %-24s %s\n", "--loss <%>", "Packet loss in percent (default 0)");
+	std::printf("    %-24s %s\n", "--reorder <%>", "Packets delayed by an extra jitter window in percent (default 0)");
+	std::printf("    %-24s %s\n", "--bandwidth <B/s>", "Upload bandwidth per player, 0 for unlimited (default 0)");
+	std::printf("    %-24s %s\n", "--tick-rate <#>", "Game ticks per second (default 20)");
+	std::printf("    %-24s %s\n", "--update-rate <#>", "Game ticks per network turn (default 2)");
+	std::printf("    %-24s %s\n", "--turns-in-transit <#>", "Turns sent ahead (default 1)");
+	std::printf("    %-24s %s\n", "--message-size <bytes>", "Game message sent by each player per tick (default 64)");
+	std::printf("    %-24s %s\n", "--password <password>", "Encrypt the packets with this password");
+	std::printf("    %-24s %s\n", "--seed <#>", "Seed for the simulated network (default 0)");
+	std::exit(status);
+}
+
+const char *RequireArgument(int argc, char **argv, int &i)
+{
+	if (i + 1 == argc) {
+		std::printf("%s requires an argument\n", argv[i]);
+		std::exit(1);
+	}
+	return argv[++i];
+}
+
+int RequireIntArgument(int argc, char **argv, int &i, int minimum, int maximum = INT32_MAX)
+{
+	const char *option = argv[i];
+	int value = std::atoi(RequireArgument(argc, argv, i));
+	if (value < minimum || value > maximum) {
+		std::printf("%s must be between %d and %d\n", option, minimum, maximum);
+		std::exit(1);
+	}
+	return value;
+}
+
+BenchOptions ParseFlags(int argc, char **argv)
+{
+	BenchOptions options;
+	for (int i = 1; i < argc; i++) {
+		const string_view arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			PrintHelpAndExit(0);
+		} else if (arg == "--version") {
+			std::printf("%s v%s\n", PROJECT_NAME, PROJECT_VERSION);
+			std::exit(0);
+		} else if (arg == "--players") {
+			options.players = RequireIntArgument(argc, argv, i, 2, MAX_PLRS);
+		} else if (arg == "--seconds") {
+			options.seconds = RequireIntArgument(argc, argv, i, 1);
+		} else if (arg == "--latency") {
+			options.conditions.latency_ms = RequireIntArgument(argc, argv, i, 0);
+		} else if (arg == "--jitter") {
+			options.conditions.jitter_ms = RequireIntArgument(argc, argv, i, 0);
+		} else if (arg == "--loss") {
+			options.conditions.loss = RequireIntArgument(argc, argv, i, 0, 100) / 100.F;
+		} else if (arg == "--reorder") {
+			options.conditions.reorder = RequireIntArgument(argc, argv, i, 0, 100) / 100.F;
+		} else if (arg == "--bandwidth") {
+			options.conditions.bandwidth = RequireIntArgument(argc, argv, i, 0);
+		} else if (arg == "--tick-rate") {
+			options.tickRate = RequireIntArgument(argc, argv, i, 1, 1000);
+		} else if (arg == "--update-rate") {
+			options.updateRate = RequireIntArgument(argc, argv, i, 1);
+		} else if (arg == "--turns-in-transit") {
+			options.turnsInTransit = RequireIntArgument(argc, argv, i, 1);
+		} else if (arg == "--message-size") {
+			options.messageSize = RequireIntArgument(argc, argv, i, 0, 512);
+		} else if (arg == "--password") {
+			options.password = RequireArgument(argc, argv, i);
+			options.hasPassword = true;
+		} else if (arg == "--seed") {
+			options.conditions.seed = RequireIntArgument(argc, argv, i, 0);
+		} else {
+			std::printf("unrecognized option '%s'\n", argv[i]);
+			PrintHelpAndExit(1);
+		}
+	}
+	return options;
+}
+
+/**
+ * @brief Exchange messages until every player has heard from everybody else
+ *
+ * Players only learn about peers that joined after them once those send something.
+ */
+void WaitForPeers(Bench &bench, VirtualPlayer &player)
+{
+	std::set<int> heard;
+	bool counted = false;
+	uint64_t lastHello = 0;
+	while (bench.ready < bench.options.players && !bench.failed) {
+		if (NowUs() - lastHello > 50000) {
+			uint8_t hello = 0;
+			player.net->SNetSendMessage(SNPLAYER_OTHERS, &hello, sizeof(hello));
+			lastHello = NowUs();
+		}
+		int sender;
+		void *data;
+		uint32_t size;
+		while (player.net->SNetReceiveMessage(&sender, &data, &size))
+			heard.insert(sender);
+		if (!counted && static_cast<int>(heard.size()) == bench.options.players - 1) {
+			counted = true;
+			bench.ready++;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+/**
+ * @brief Play the game the way nthread does: send turns ahead, and stall the game tick until
+ * the turns of all players have arrived
+ */
+void RunPlayer(Bench &bench, int index)
+{
+	const BenchOptions &options = bench.options;
+	VirtualPlayer &player = bench.players[index];
+
+	int pnum;
+	if (index == 0) {
+		pnum = player.net->create("sim");
+	} else {
+		while (bench.joined < index && !bench.failed)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (bench.failed)
+			return;
+		pnum = player.net->join("sim");
+	}
+	if (pnum != index) {
+		std::printf("virtual player %d failed to join\n", index);
+		bench.failed = true;
+		return;
+	}
+	bench.joined++;
+	WaitForPeers(bench, player);
+	if (bench.failed)
+		return;
+
+	const uint64_t tickDelayUs = 1000000 / options.tickRate;
+	std::vector<uint8_t> message(options.messageSize);
+	char *turnData[MAX_PLRS];
+	size_t turnSize[MAX_PLRS];
+	uint32_t status[MAX_PLRS];
+	int nextTurn = 0;
+	int packetCountdown = 1;
+	const uint64_t gameStart = NowUs();
+	uint64_t lastTick = gameStart;
+
+	for (int tick = 0; tick < bench.ticks; tick++) {
+		uint32_t inTransit;
+		player.net->SNetGetTurnsInTransit(&inTransit);
+		while (inTransit++ < static_cast<uint32_t>(options.turnsInTransit)) {
+			int turn = nextTurn++;
+			bench.turnSentAt[index][turn] = NowUs();
+			player.net->SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn));
+		}
+
+		if (--packetCountdown == 0) {
+			packetCountdown = options.updateRate;
+			uint64_t waitStart = NowUs();
+			while (!player.net->SNetReceiveTurns(turnData, turnSize, status)) {
+				if (bench.failed)
+					return;
+				if (NowUs() - waitStart > 30000000) {
+					std::printf("virtual player %d gave up waiting for turns\n", index);
+					bench.failed = true;
+					return;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			uint64_t now = NowUs();
+			for (int i = 0; i < options.players; i++) {
+				if (i == index || (status[i] & PS_TURN_ARRIVED) == 0)
+					continue;
+				int turn = *reinterpret_cast<int *>(turnData[i]);
+				player.turnLatencies.push_back(now - bench.turnSentAt[i][turn]);
+			}
+			// Like nthread, the pacing restarts after a stall instead of catching up
+			if (now > lastTick + tickDelayUs) {
+				player.stalledUs += now - std::max(waitStart, lastTick);
+				lastTick = now;
+			}
+		}
+
+		if (!message.empty())
+			player.net->SNetSendMessage(SNPLAYER_OTHERS, message.data(), message.size());
+		int sender;
+		void *data;
+		uint32_t size;
+		while (player.net->SNetReceiveMessage(&sender, &data, &size)) {
+		}
+
+		lastTick += tickDelayUs;
+		SleepUntilUs(lastTick);
+	}
+	player.gameUs = NowUs() - gameStart;
+}
+
+uint64_t Percentile(const std::vector<uint64_t> &sorted, int percent)
+{
+	if (sorted.empty())
+		return 0;
+	return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+int RunBench(const BenchOptions &options)
+{
+	sim_network::Default().SetConditions(options.conditions);
+	Bench bench(options);
+	for (auto &player : bench.players) {
+		player.net = std::make_unique<base_protocol<protocol_sim>>();
+		if (options.hasPassword)
+			player.net->setup_password(options.password);
+		else
+			player.net->clear_password();
+		player.net->setup_gameinfo(buffer_t(sizeof(GameData)));
+	}
+
+	std::printf("%d players, %d ticks at %d ticks/s, update rate %d, %d turn(s) in transit\n",
+	    options.players, bench.ticks, options.tickRate, options.updateRate, options.turnsInTransit);
+	std::printf("latency %u ms, jitter %u ms, loss %.0f%%, reorder %.0f%%, bandwidth %u B/s\n",
+	    options.conditions.latency_ms, options.conditions.jitter_ms, options.conditions.loss * 100,
+	    options.conditions.reorder * 100, options.conditions.bandwidth);
+
+	for (int i = 0; i < options.players; i++)
+		bench.players[i].thread = std::thread(RunPlayer, std::ref(bench), i);
+	for (auto &player : bench.players)
+		player.thread.join();
+	if (bench.failed)
+		return 1;
+
+	std::vector<uint64_t> latencies;
+	uint64_t stalledUs = 0;
+	uint64_t gameUs = 0;
+	for (auto &player : bench.players) {
+		gameUs = std::max(gameUs, player.gameUs);
+		latencies.insert(latencies.end(), player.turnLatencies.begin(), player.turnLatencies.end());
+		stalledUs += player.stalledUs;
+	}
+	std::sort(latencies.begin(), latencies.end());
+	const sim_stats stats = sim_network::Default().Stats();
+	const double seconds = gameUs / 1000000.0;
+	const double playerTicks = static_cast<double>(bench.ticks) * options.players;
+
+	std::printf("ran %.2f s, expected %.2f s\n", seconds, static_cast<double>(bench.ticks) / options.tickRate);
+	std::printf("turn latency ms: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f (%zu samples)\n",
+	    Percentile(latencies, 50) / 1000.0, Percentile(latencies, 90) / 1000.0,
+	    Percentile(latencies, 99) / 1000.0, Percentile(latencies, 100) / 1000.0, latencies.size());
+	std::printf("stalled %.1f ms per player (%.1f%% of the game)\n",
+	    stalledUs / 1000.0 / options.players, stalledUs / 10000.0 / options.players / seconds);
+	std::printf("traffic per player and tick: %.1f bytes, %.2f packets, %.3f lost\n",
+	    stats.bytes_sent / playerTicks, stats.packets_sent / playerTicks, stats.packets_lost / playerTicks);
+
+	bench.players.clear();
+	return 0;
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::net::BenchOptions options = devilution::net::ParseFlags(argc, argv);
+	return devilution::net::RunBench(options);
+}
@@ -58,6 +58,8 @@ const char *packet_type_to_string(uint8_t packetType)
 		return "PT_MESSAGE";
 	case PT_TURN:
 		return "PT_TURN";
+	case PT_BUNDLE:
+		return "PT_BUNDLE";
 	case PT_JOIN_REQUEST:
 		return "PT_JOIN_REQUEST";
 	case PT_JOIN_ACCEPT:
@@ -141,6 +143,13 @@ const buffer_t &packet::Message()
 	return m_message;
 }
 
+const buffer_t &packet::Bundle()
+{
+	assert(have_decrypted);
+	CheckPacketTypeOneOf({ PT_BUNDLE }, m_type);
+	return m_message;
+}
+
 turn_t packet::Turn()
 {
 	assert(have_decrypted);
@@ -182,14 +191,10 @@ void packet_in::Create(buffer_t buf)
 	if (buf.size() < sizeof(packet_type) + 2 * sizeof(plr_t))
 		throw packet_exception();
 
+	// Parsing only advances decrypted_offset, so the buffer keeps the original
+	// data that Data() returns when the TCP server forwards it to clients
 	decrypted_buffer = std::move(buf);
 	have_decrypted = true;
-
-	// TCP server implementation forwards the original data to clients
-	// so although we are not decrypting anything,
-	// we save a copy in encrypted_buffer anyway
-	encrypted_buffer = decrypted_buffer;
-	have_encrypted = true;
 }
 
 #ifdef PACKET_ENCRYPTION
@@ -247,6 +252,32 @@ void packet_out::Encrypt()
 }
 #endif
 
+void packet_factory::append_bundled(buffer_t &bundle, const buffer_t &data)
+{
+	uint16_t size = static_cast<uint16_t>(data.size());
+	const auto *sizeBytes = reinterpret_cast<const unsigned char *>(&size);
+	bundle.insert(bundle.end(), sizeBytes, sizeBytes + sizeof(size));
+	bundle.insert(bundle.end(), data.begin(), data.end());
+}
+
+size_t packet_factory::count_bundled(const buffer_t &bundle, packet_type type)
+{
+	size_t count = 0;
+	size_t offset = 0;
+	uint16_t size;
+	while (bundle.size() - offset >= sizeof(size)) {
+		std::memcpy(&size, bundle.data() + offset, sizeof(size));
+		offset += sizeof(size);
+		if (size == 0 || bundle.size() - offset < size)
+			break;
+		// The packet type is the first byte of each embedded packet
+		if (bundle[offset] == type)
+			count++;
+		offset += size;
+	}
+	return count;
+}
+
 packet_factory::packet_factory()
 {
 	secure = false;
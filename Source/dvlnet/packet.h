@@ -5,6 +5,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
 
 #ifdef PACKET_ENCRYPTION
 #include <sodium.h>
@@ -20,6 +21,7 @@ enum packet_type : uint8_t {
 	// clang-format off
 	PT_MESSAGE      = 0x01,
 	PT_TURN         = 0x02,
+	PT_BUNDLE       = 0x03,
 	PT_JOIN_REQUEST = 0x11,
 	PT_JOIN_ACCEPT  = 0x12,
 	PT_CONNECT      = 0x13,
@@ -84,6 +86,8 @@ protected:
 	bool have_decrypted = false;
 	buffer_t encrypted_buffer;
 	buffer_t decrypted_buffer;
+	/** Read position in decrypted_buffer while parsing a received packet */
+	size_t decrypted_offset = 0;
 
 public:
 	packet(const key_t &k)
@@ -95,6 +99,7 @@ public:
 	plr_t Source() const;
 	plr_t Destination() const;
 	const buffer_t &Message();
+	const buffer_t &Bundle();
 	turn_t Turn();
 	cookie_t Cookie();
 	plr_t NewPlayer();
@@ -151,6 +156,9 @@ void packet_proc<P>::process_data()
 	case PT_TURN:
 		self.process_element(m_turn);
 		break;
+	case PT_BUNDLE:
+		self.process_element(m_message);
+		break;
 	case PT_JOIN_REQUEST:
 		self.process_element(m_cookie);
 		self.process_element(m_info);
@@ -178,18 +186,17 @@ void packet_proc<P>::process_data()
 
 inline void packet_in::process_element(buffer_t &x)
 {
-	x.insert(x.begin(), decrypted_buffer.begin(), decrypted_buffer.end());
-	decrypted_buffer.resize(0);
+	x.assign(decrypted_buffer.begin() + decrypted_offset, decrypted_buffer.end());
+	decrypted_offset = decrypted_buffer.size();
 }
 
 template <class T>
 void packet_in::process_element(T &x)
 {
-	if (decrypted_buffer.size() < sizeof(T))
+	if (decrypted_buffer.size() - decrypted_offset < sizeof(T))
 		throw packet_exception();
-	std::memcpy(&x, decrypted_buffer.data(), sizeof(T));
-	decrypted_buffer.erase(decrypted_buffer.begin(),
-	    decrypted_buffer.begin() + sizeof(T));
+	std::memcpy(&x, decrypted_buffer.data() + decrypted_offset, sizeof(T));
+	decrypted_offset += sizeof(T);
 }
 
 template <>
@@ -239,6 +246,18 @@ inline void packet_out::create<PT_TURN>(plr_t s, plr_t d, turn_t u)
 	m_turn = u;
 }
 
+template <>
+inline void packet_out::create<PT_BUNDLE>(plr_t s, plr_t d, buffer_t b)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_BUNDLE;
+	m_src = s;
+	m_dest = d;
+	m_message = std::move(b);
+}
+
 template <>
 inline void packet_out::create<PT_JOIN_REQUEST>(plr_t s, plr_t d,
     cookie_t c, buffer_t i)
@@ -250,7 +269,7 @@ inline void packet_out::create<PT_JOIN_REQUEST>(plr_t s, plr_t d,
 	m_src = s;
 	m_dest = d;
 	m_cookie = c;
-	m_info = i;
+	m_info = std::move(i);
 }
 
 template <>
@@ -265,7 +284,7 @@ inline void packet_out::create<PT_JOIN_ACCEPT>(plr_t s, plr_t d, cookie_t c,
 	m_dest = d;
 	m_cookie = c;
 	m_newplr = n;
-	m_info = i;
+	m_info = std::move(i);
 }
 
 template <>
@@ -278,7 +297,7 @@ inline void packet_out::create<PT_CONNECT>(plr_t s, plr_t d, plr_t n, buffer_t i
 	m_src = s;
 	m_dest = d;
 	m_newplr = n;
-	m_info = i;
+	m_info = std::move(i);
 }
 
 template <>
@@ -342,6 +361,33 @@ public:
 	std::unique_ptr<packet> make_packet(buffer_t buf);
 	template <packet_type t, typename... Args>
 	std::unique_ptr<packet> make_packet(Args... args);
+
+	/**
+	 * @brief Create a packet that is never encrypted, for embedding in a PT_BUNDLE
+	 *
+	 * The enclosing bundle is encrypted and authenticated as a whole.
+	 */
+	template <packet_type t, typename... Args>
+	std::unique_ptr<packet> make_plain_packet(Args... args);
+
+	/**
+	 * @brief Parse each packet embedded in a PT_BUNDLE
+	 *
+	 * Only PT_MESSAGE and PT_TURN packets with the same source and destination
+	 * as the bundle are accepted, anything else throws a packet_exception.
+	 */
+	template <typename F>
+	void for_each_bundled(packet &bundle, F &&f);
+
+	/** Append the data of a packet created by make_plain_packet to the payload of a PT_BUNDLE */
+	static void append_bundled(buffer_t &bundle, const buffer_t &data);
+
+	/**
+	 * @brief Count the embedded packets of the given type by reading their headers in place
+	 *
+	 * Doesn't validate the packets, a truncated payload is counted up to the damaged entry.
+	 */
+	static size_t count_bundled(const buffer_t &bundle, packet_type type);
 };
 
 inline std::unique_ptr<packet> packet_factory::make_packet(buffer_t buf)
@@ -363,7 +409,7 @@ template <packet_type t, typename... Args>
 std::unique_ptr<packet> packet_factory::make_packet(Args... args)
 {
 	auto ret = std::make_unique<packet_out>(key);
-	ret->create<t>(args...);
+	ret->create<t>(std::move(args)...);
 	ret->process_data();
 #ifdef PACKET_ENCRYPTION
 	if (secure)
@@ -372,5 +418,39 @@ std::unique_ptr<packet> packet_factory::make_packet(Args... args)
 	return ret;
 }
 
+template <packet_type t, typename... Args>
+std::unique_ptr<packet> packet_factory::make_plain_packet(Args... args)
+{
+	auto ret = std::make_unique<packet_out>(key);
+	ret->create<t>(std::move(args)...);
+	ret->process_data();
+	return ret;
+}
+
+template <typename F>
+void packet_factory::for_each_bundled(packet &bundle, F &&f)
+{
+	const buffer_t &data = bundle.Bundle();
+	size_t offset = 0;
+	while (offset < data.size()) {
+		uint16_t size;
+		if (data.size() - offset < sizeof(size))
+			throw packet_exception();
+		std::memcpy(&size, data.data() + offset, sizeof(size));
+		offset += sizeof(size);
+		if (data.size() - offset < size)
+			throw packet_exception();
+		packet_in pkt(key);
+		pkt.Create(buffer_t(data.begin() + offset, data.begin() + offset + size));
+		pkt.process_data();
+		offset += size;
+		if (pkt.Source() != bundle.Source() || pkt.Destination() != bundle.Destination())
+			throw packet_exception();
+		if (pkt.Type() != PT_MESSAGE && pkt.Type() != PT_TURN)
+			throw wrong_packet_type_exception({ PT_MESSAGE, PT_TURN }, pkt.Type());
+		f(static_cast<packet &>(pkt));
+	}
+}
+
 } // namespace net
 } // namespace devilution
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <exception>
+
+namespace devilution {
+namespace net {
+
+class protocol_exception : public std::exception {
+public:
+	const char *what() const throw() override
+	{
+		return "Protocol error";
+	}
+};
+
+} // namespace net
+} // namespace devilution
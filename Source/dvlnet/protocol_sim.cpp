@@ -0,0 +1,257 @@
+#include "dvlnet/protocol_sim.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "dvlnet/protocol_exception.h"
+
+namespace devilution {
+namespace net {
+
+namespace {
+
+/** Lower bound of the retransmission timeout of a stream, as used by common TCP stacks */
+constexpr uint64_t MinRetransmitTimeoutUs = 200000;
+/** Give up retransmitting after this many attempts and deliver anyway */
+constexpr int MaxRetransmits = 8;
+
+} // namespace
+
+sim_network::sim_network(bool manualClock)
+    : manual_clock(manualClock)
+{
+}
+
+sim_network &sim_network::Default()
+{
+	static sim_network network;
+	return network;
+}
+
+void sim_network::SetConditions(const sim_conditions &conditions)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->conditions = conditions;
+	rng.seed(conditions.seed);
+}
+
+void sim_network::Advance(uint32_t ms)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	manual_now_us += static_cast<uint64_t>(ms) * 1000;
+}
+
+sim_stats sim_network::Stats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+uint64_t sim_network::NowUs() const
+{
+	if (manual_clock)
+		return manual_now_us;
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+float sim_network::Roll()
+{
+	return std::uniform_real_distribution<float>(0, 1)(rng);
+}
+
+uint32_t sim_network::Register()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	uint32_t id = next_id++;
+	endpoints[id];
+	return id;
+}
+
+void sim_network::Unregister(uint32_t id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	endpoints.erase(id);
+	for (auto &other : endpoints) {
+		if (other.second.stream_tail.erase(id) != 0)
+			other.second.disconnected.push_back(id);
+	}
+}
+
+void sim_network::Transmit(uint32_t sender, uint32_t receiver, const buffer_t &data, bool stream)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto from = endpoints.find(sender);
+	auto to = endpoints.find(receiver);
+	if (from == endpoints.end() || to == endpoints.end())
+		return;
+
+	uint64_t now = NowUs();
+	uint64_t deliverAt = std::max(now, from->second.uplink_busy_until);
+	if (conditions.bandwidth != 0)
+		deliverAt += data.size() * 1000000 / conditions.bandwidth;
+	from->second.uplink_busy_until = deliverAt;
+	stats.bytes_sent += data.size();
+	stats.packets_sent++;
+
+	const uint64_t jitter = static_cast<uint64_t>(conditions.jitter_ms) * 1000;
+	deliverAt += static_cast<uint64_t>(conditions.latency_ms) * 1000;
+	if (jitter != 0)
+		deliverAt += std::uniform_int_distribution<uint64_t>(0, jitter)(rng);
+	if (Roll() < conditions.reorder)
+		deliverAt += jitter;
+
+	if (stream) {
+		// A lost segment is resent once the retransmission timeout expires, doubling each time
+		uint64_t timeout = std::max(MinRetransmitTimeoutUs, 2 * static_cast<uint64_t>(conditions.latency_ms) * 1000 + 4 * jitter);
+		for (int i = 0; i < MaxRetransmits && Roll() < conditions.loss; i++) {
+			stats.packets_lost++;
+			deliverAt += timeout;
+			timeout *= 2;
+		}
+		// Nothing overtakes an earlier packet of the same stream
+		uint64_t &tail = from->second.stream_tail[receiver];
+		deliverAt = std::max(deliverAt, tail);
+		tail = deliverAt;
+		to->second.stream_tail.emplace(sender, 0);
+	} else if (Roll() < conditions.loss) {
+		stats.packets_lost++;
+		return;
+	}
+
+	datagram packet { deliverAt, next_order++, sender, data };
+	auto &inbox = to->second.inbox;
+	auto pos = std::upper_bound(inbox.begin(), inbox.end(), packet, [](const datagram &a, const datagram &b) {
+		return a.deliver_at < b.deliver_at || (a.deliver_at == b.deliver_at && a.order < b.order);
+	});
+	inbox.insert(pos, std::move(packet));
+}
+
+bool sim_network::Receive(uint32_t receiver, uint32_t &sender, buffer_t &data)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = endpoints.find(receiver);
+	if (it == endpoints.end())
+		return false;
+	auto &inbox = it->second.inbox;
+	if (inbox.empty() || inbox.front().deliver_at > NowUs())
+		return false;
+	sender = inbox.front().sender;
+	data = std::move(inbox.front().data);
+	inbox.pop_front();
+	return true;
+}
+
+void sim_network::Disconnect(uint32_t self, uint32_t peer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = endpoints.find(self);
+	if (it != endpoints.end())
+		it->second.stream_tail.erase(peer);
+	auto other = endpoints.find(peer);
+	if (other != endpoints.end() && other->second.stream_tail.erase(self) != 0)
+		other->second.disconnected.push_back(self);
+}
+
+bool sim_network::PopDisconnected(uint32_t self, uint32_t &peer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = endpoints.find(self);
+	if (it == endpoints.end() || it->second.disconnected.empty())
+		return false;
+	peer = it->second.disconnected.front();
+	it->second.disconnected.pop_front();
+	return true;
+}
+
+std::vector<uint32_t> sim_network::Endpoints()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<uint32_t> ids;
+	ids.reserve(endpoints.size());
+	for (auto &entry : endpoints)
+		ids.push_back(entry.first);
+	return ids;
+}
+
+buffer_t protocol_sim::endpoint::serialize() const
+{
+	buffer_t buf(sizeof(id));
+	for (size_t i = 0; i < sizeof(id); i++)
+		buf[i] = static_cast<unsigned char>(id >> (8 * i));
+	return buf;
+}
+
+void protocol_sim::endpoint::unserialize(const buffer_t &buf)
+{
+	if (buf.size() != sizeof(id))
+		throw protocol_exception();
+	id = 0;
+	for (size_t i = 0; i < sizeof(id); i++)
+		id |= static_cast<uint32_t>(buf[i]) << (8 * i);
+}
+
+protocol_sim::protocol_sim()
+    : protocol_sim(sim_network::Default())
+{
+}
+
+protocol_sim::protocol_sim(sim_network &network)
+    : network(network)
+    , self(network.Register())
+{
+}
+
+protocol_sim::~protocol_sim()
+{
+	network.Unregister(self);
+}
+
+void protocol_sim::disconnect(const endpoint &peer)
+{
+	network.Disconnect(self, peer.id);
+}
+
+bool protocol_sim::send(const endpoint &peer, const buffer_t &data)
+{
+	network.Transmit(self, peer.id, data, true);
+	return true;
+}
+
+bool protocol_sim::send_oob(const endpoint &peer, const buffer_t &data) const
+{
+	network.Transmit(self, peer.id, data, false);
+	return true;
+}
+
+bool protocol_sim::send_oob_mc(const buffer_t &data) const
+{
+	for (uint32_t id : network.Endpoints()) {
+		if (id != self)
+			network.Transmit(self, id, data, false);
+	}
+	return true;
+}
+
+bool protocol_sim::recv(endpoint &peer, buffer_t &data)
+{
+	return network.Receive(self, peer.id, data);
+}
+
+bool protocol_sim::get_disconnected(endpoint &peer)
+{
+	return network.PopDisconnected(self, peer.id);
+}
+
+bool protocol_sim::network_online()
+{
+	return true;
+}
+
+std::string protocol_sim::make_default_gamename()
+{
+	return "sim";
+}
+
+} // namespace net
+} // namespace devilution
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dvlnet/abstract_net.h"
+
+namespace devilution {
+namespace net {
+
+/**
+ * @brief Link conditions applied by sim_network to every packet
+ */
+struct sim_conditions {
+	/** One way latency in milliseconds */
+	uint32_t latency_ms = 0;
+	/** Maximum random delay in milliseconds added on top of the latency */
+	uint32_t jitter_ms = 0;
+	/** Probability of a packet being lost, streams retransmit it after a timeout */
+	float loss = 0;
+	/** Probability of a packet arriving one extra jitter window late */
+	float reorder = 0;
+	/** Upload bandwidth of each endpoint in bytes per second, 0 for unlimited */
+	uint32_t bandwidth = 0;
+	uint32_t seed = 0;
+};
+
+struct sim_stats {
+	uint64_t bytes_sent = 0;
+	uint64_t packets_sent = 0;
+	/** Stream packets that needed a retransmit and datagrams that were dropped */
+	uint64_t packets_lost = 0;
+};
+
+/**
+ * @brief In-process network connecting any number of protocol_sim endpoints
+ *
+ * Streams (protocol_sim::send) behave like TCP connections: nothing is dropped and packets are
+ * delivered in order, so loss and reordering show up as head-of-line delay. Out-of-band
+ * datagrams behave like UDP and are dropped or overtaken.
+ *
+ * All members are thread-safe, so every virtual player can run on its own thread.
+ */
+class sim_network {
+public:
+	/**
+	 * @param manualClock Only advance the time on calls to Advance, otherwise follow the steady clock
+	 */
+	explicit sim_network(bool manualClock = false);
+
+	/** Network used by default constructed protocol_sim instances */
+	static sim_network &Default();
+
+	void SetConditions(const sim_conditions &conditions);
+	void Advance(uint32_t ms);
+	sim_stats Stats();
+
+private:
+	friend class protocol_sim;
+
+	struct datagram {
+		uint64_t deliver_at;
+		uint64_t order;
+		uint32_t sender;
+		buffer_t data;
+	};
+
+	struct endpoint_state {
+		/** Packets in flight towards the endpoint */
+		std::deque<datagram> inbox;
+		std::deque<uint32_t> disconnected;
+		/** Time the uplink finishes sending everything queued so far */
+		uint64_t uplink_busy_until = 0;
+		/** Latest delivery time of each outgoing stream, keeps streams in order */
+		std::map<uint32_t, uint64_t> stream_tail;
+	};
+
+	std::mutex mutex;
+	sim_conditions conditions;
+	std::mt19937 rng;
+	bool manual_clock;
+	uint64_t manual_now_us = 0;
+	uint64_t next_order = 0;
+	uint32_t next_id = 1;
+	std::map<uint32_t, endpoint_state> endpoints;
+	sim_stats stats;
+
+	uint64_t NowUs() const;
+	float Roll();
+	uint32_t Register();
+	void Unregister(uint32_t id);
+	void Transmit(uint32_t sender, uint32_t receiver, const buffer_t &data, bool stream);
+	bool Receive(uint32_t receiver, uint32_t &sender, buffer_t &data);
+	void Disconnect(uint32_t self, uint32_t peer);
+	bool PopDisconnected(uint32_t self, uint32_t &peer);
+	std::vector<uint32_t> Endpoints();
+};
+
+/**
+ * @brief Protocol for base_protocol running over a sim_network
+ */
+class protocol_sim {
+public:
+	class endpoint {
+	public:
+		uint32_t id = 0;
+
+		explicit operator bool() const
+		{
+			return id != 0;
+		}
+
+		bool operator==(const endpoint &rhs) const
+		{
+			return id == rhs.id;
+		}
+
+		bool operator!=(const endpoint &rhs) const
+		{
+			return !(*this == rhs);
+		}
+
+		bool operator<(const endpoint &rhs) const
+		{
+			return id < rhs.id;
+		}
+
+		buffer_t serialize() const;
+		void unserialize(const buffer_t &buf);
+	};
+
+	protocol_sim();
+	explicit protocol_sim(sim_network &network);
+	~protocol_sim();
+	protocol_sim(const protocol_sim &) = delete;
+	protocol_sim &operator=(const protocol_sim &) = delete;
+
+	void disconnect(const endpoint &peer);
+	bool send(const endpoint &peer, const buffer_t &data);
+	bool send_oob(const endpoint &peer, const buffer_t &data) const;
+	bool send_oob_mc(const buffer_t &data) const;
+	bool recv(endpoint &peer, buffer_t &data);
+	bool get_disconnected(endpoint &peer);
+	bool network_online();
+	static std::string make_default_gamename();
+
+private:
+	sim_network &network;
+	uint32_t self;
+};
+
+} // namespace net
+} // namespace devilution
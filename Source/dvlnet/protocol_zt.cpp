@@ -150,11 +150,11 @@ bool protocol_zt::send_queued_peer(const endpoint &peer)
 
 bool protocol_zt::recv_peer(const endpoint &peer)
 {
-	unsigned char buf[PKTBUF_LEN];
 	while (true) {
-		auto len = lwip_recv(peer_list[peer].fd, buf, sizeof(buf), 0);
+		auto &recvQueue = peer_list[peer].recv_queue;
+		auto len = lwip_recv(peer_list[peer].fd, recvQueue.Prepare(PKTBUF_LEN), PKTBUF_LEN, 0);
 		if (len >= 0) {
-			peer_list[peer].recv_queue.Write(buffer_t(buf, buf + len));
+			recvQueue.Commit(len);
 		} else {
 			return errno == EAGAIN || errno == EWOULDBLOCK;
 		}
@@ -4,24 +4,16 @@
 #include <array>
 #include <atomic>
 #include <deque>
-#include <exception>
 #include <map>
 #include <set>
 #include <string>
 
 #include "dvlnet/frame_queue.h"
+#include "dvlnet/protocol_exception.h"
 
 namespace devilution {
 namespace net {
 
-class protocol_exception : public std::exception {
-public:
-	const char *what() const throw() override
-	{
-		return "Protocol error";
-	}
-};
-
 class protocol_zt {
 public:
 	class endpoint {
@@ -0,0 +1,341 @@
+/**
+ * @file dvlnet/server_main.cpp
+ *
+ * Standalone TCP relay that hosts several games without running a game client.
+ */
+// The relay has its own entry point and never initializes SDL
+#define SDL_MAIN_HANDLED
+
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/executor_work_guard.hpp>
+#include <asio/signal_set.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/ts/io_context.hpp>
+
+#include "config.h"
+#include "diablo.h"
+#include "dvlnet/packet.h"
+#include "dvlnet/tcp_server.h"
+#include "encrypt.h"
+#include "utils/log.hpp"
+#include "utils/stdcompat/string_view.hpp"
+
+namespace devilution {
+namespace net {
+namespace {
+
+struct RelayOptions {
+	std::string bindAddress = "0.0.0.0";
+	unsigned short port = 6112;
+	int games = 1;
+	int threads = 1;
+	bool hasPassword = false;
+	std::string password;
+	int statsInterval = 10;
+	/** Settings of the hosted games, clients take them from the relay since none of them creates the game */
+	_difficulty difficulty = DIFF_NORMAL;
+	int tickRate = 20;
+	bool runInTown = false;
+	bool theoQuest = false;
+	bool cowQuest = false;
+	bool friendlyFire = true;
+};
+
+/**
+ * @brief A hosted game, listening on its own port with its own connection table
+ */
+struct RelayGame {
+	unsigned short port;
+	std::unique_ptr<packet_factory> pktfty;
+	std::unique_ptr<tcp_server> server;
+};
+
+/**
+ * @brief Thread running one io_context
+ *
+ * Each game is bound to exactly one worker, so a tcp_server is never accessed concurrently.
+ */
+struct RelayWorker {
+	asio::io_context ioc;
+	asio::executor_work_guard<asio::io_context::executor_type> work = asio::make_work_guard(ioc);
+	std::thread thread;
+};
+
+struct RelayTotals {
+	uint32_t activeGames = 0;
+	uint32_t players = 0;
+	uint64_t bytesReceived = 0;
+	uint64_t bytesSent = 0;
+	uint64_t turns = 0;
+};
+
+[[noreturn]] void PrintHelpAndExit(int status)
+{
+	std::printf("Usage: devilutionx-server [options]\n\n");
+	std::printf("    %-24s %s\n", "-h, --help", "Print this message and exit");
+	std::printf("    %-24s %s\n", "--version", "Print the version and exit");
+	std::printf("    %-24s %s\n", "--bind <address>", "Address to listen on (default 0.0.0.0)");
+	std::printf("    %-24s %s\n", "--port <port>", "Port of the first game (default 6112)");
+	std::printf("    %-24s %s\n", "--games <#>", "Number of games to host, on consecutive ports (default 1)");
+	std::printf("    %-24s %s\n", "--threads <#>", "Number of network threads (default 1)");
+	std::printf("    %-24s %s\n", "--password <password>", "Game password, omit to host public games");
+	std::printf("    %-24s %s\n", "--stats-interval <sec>", "Seconds between statistics reports, 0 to disable (default 10)");
+	std::printf("    %-24s %s\n", "--hellfire", "Host Hellfire games");
+	std::printf("    %-24s %s\n", "--spawn", "Host games of the shareware version");
+	std::printf("    %-24s %s\n", "--difficulty <name>", "normal, nightmare or hell (default normal)");
+	std::printf("    %-24s %s\n", "--tick-rate <#>", "Game speed in ticks per second, 20 to 50 (default 20)");
+	std::printf("    %-24s %s\n", "--run-in-town", "Allow running in town");
+	std::printf("    %-24s %s\n", "--theo-quest", "Enable the Little Girl quest (Hellfire)");
+	std::printf("    %-24s %s\n", "--cow-quest", "Enable Jersey's quest (Hellfire)");
+	std::printf("    %-24s %s\n", "--no-friendly-fire", "Disable damage between players in friendly mode");
+	std::exit(status);
+}
+
+const char *RequireArgument(int argc, char **argv, int &i)
+{
+	if (i + 1 == argc) {
+		std::printf("%s requires an argument\n", argv[i]);
+		std::exit(1);
+	}
+	return argv[++i];
+}
+
+int RequireIntArgument(int argc, char **argv, int &i, int minimum, int maximum = INT_MAX)
+{
+	const char *option = argv[i];
+	int value = std::atoi(RequireArgument(argc, argv, i));
+	if (value < minimum) {
+		std::printf("%s must be at least %d\n", option, minimum);
+		std::exit(1);
+	}
+	if (value > maximum) {
+		std::printf("%s must be at most %d\n", option, maximum);
+		std::exit(1);
+	}
+	return value;
+}
+
+RelayOptions ParseFlags(int argc, char **argv)
+{
+	RelayOptions options;
+	for (int i = 1; i < argc; i++) {
+		const string_view arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			PrintHelpAndExit(0);
+		} else if (arg == "--version") {
+			std::printf("%s v%s\n", PROJECT_NAME, PROJECT_VERSION);
+			std::exit(0);
+		} else if (arg == "--bind") {
+			options.bindAddress = RequireArgument(argc, argv, i);
+		} else if (arg == "--port") {
+			options.port = static_cast<unsigned short>(RequireIntArgument(argc, argv, i, 1, UINT16_MAX));
+		} else if (arg == "--games") {
+			options.games = RequireIntArgument(argc, argv, i, 1);
+		} else if (arg == "--threads") {
+			options.threads = RequireIntArgument(argc, argv, i, 1);
+		} else if (arg == "--password") {
+			options.password = RequireArgument(argc, argv, i);
+			options.hasPassword = true;
+		} else if (arg == "--stats-interval") {
+			options.statsInterval = RequireIntArgument(argc, argv, i, 0);
+		} else if (arg == "--hellfire") {
+			gbIsHellfire = true;
+		} else if (arg == "--spawn") {
+			gbIsSpawn = true;
+		} else if (arg == "--difficulty") {
+			const string_view name = RequireArgument(argc, argv, i);
+			if (name == "normal") {
+				options.difficulty = DIFF_NORMAL;
+			} else if (name == "nightmare") {
+				options.difficulty = DIFF_NIGHTMARE;
+			} else if (name == "hell") {
+				options.difficulty = DIFF_HELL;
+			} else {
+				std::printf("--difficulty must be normal, nightmare or hell\n");
+				std::exit(1);
+			}
+		} else if (arg == "--tick-rate") {
+			options.tickRate = RequireIntArgument(argc, argv, i, 20, 50);
+		} else if (arg == "--run-in-town") {
+			options.runInTown = true;
+		} else if (arg == "--theo-quest") {
+			options.theoQuest = true;
+		} else if (arg == "--cow-quest") {
+			options.cowQuest = true;
+		} else if (arg == "--no-friendly-fire") {
+			options.friendlyFire = false;
+		} else {
+			std::printf("unrecognized option '%s'\n", argv[i]);
+			PrintHelpAndExit(1);
+		}
+	}
+	if (options.games - 1 > UINT16_MAX - options.port) {
+		std::printf("--games %d does not fit in the port range starting at %d\n", options.games, options.port);
+		std::exit(1);
+	}
+	return options;
+}
+
+/**
+ * @brief The GameData a client would send when creating the game, with a new dungeon seed for every game
+ */
+buffer_t MakeGameInfo(const RelayOptions &options)
+{
+	// Called from every worker thread, so each call uses its own device
+	std::random_device randomDevice;
+
+	GameData gameData {};
+	gameData.size = sizeof(gameData);
+	gameData.dwSeed = randomDevice();
+	gameData.programid = GAME_ID;
+	gameData.versionMajor = PROJECT_VERSION_MAJOR;
+	gameData.versionMinor = PROJECT_VERSION_MINOR;
+	gameData.versionPatch = PROJECT_VERSION_PATCH;
+	gameData.nDifficulty = options.difficulty;
+	gameData.nTickRate = options.tickRate;
+	gameData.bRunInTown = options.runInTown ? 1 : 0;
+	gameData.bTheoQuest = options.theoQuest ? 1 : 0;
+	gameData.bCowQuest = options.cowQuest ? 1 : 0;
+	gameData.bFriendlyFire = options.friendlyFire ? 1 : 0;
+	gameData.deltaCodec = static_cast<uint8_t>(CompressionCodec::Zlib);
+	const auto *begin = reinterpret_cast<const unsigned char *>(&gameData);
+	return buffer_t(begin, begin + sizeof(gameData));
+}
+
+RelayTotals SumStats(const std::vector<RelayGame> &games)
+{
+	RelayTotals totals;
+	for (const RelayGame &game : games) {
+		const tcp_server_stats &stats = game.server->Stats();
+		uint32_t players = stats.players.load(std::memory_order_relaxed);
+		if (players > 0)
+			totals.activeGames++;
+		totals.players += players;
+		totals.bytesReceived += stats.bytes_received.load(std::memory_order_relaxed);
+		totals.bytesSent += stats.bytes_sent.load(std::memory_order_relaxed);
+		totals.turns += stats.turns.load(std::memory_order_relaxed);
+	}
+	return totals;
+}
+
+class StatsReporter {
+public:
+	StatsReporter(asio::io_context &ioc, const std::vector<RelayGame> &games, int interval)
+	    : timer(ioc)
+	    , games(games)
+	    , interval(interval)
+	{
+		if (interval > 0)
+			Schedule();
+	}
+
+private:
+	asio::steady_timer timer;
+	const std::vector<RelayGame> &games;
+	int interval;
+	RelayTotals last;
+
+	void Schedule()
+	{
+		timer.expires_after(std::chrono::seconds(interval));
+		timer.async_wait([this](const asio::error_code &ec) {
+			if (ec)
+				return;
+			Report();
+			Schedule();
+		});
+	}
+
+	void Report()
+	{
+		RelayTotals now = SumStats(games);
+		Log("games {}/{}, players {}, in {} B/s, out {} B/s, turns {}/s",
+		    now.activeGames, games.size(), now.players,
+		    (now.bytesReceived - last.bytesReceived) / interval,
+		    (now.bytesSent - last.bytesSent) / interval,
+		    (now.turns - last.turns) / interval);
+		last = now;
+	}
+};
+
+int RunRelay(const RelayOptions &options)
+{
+	std::vector<std::unique_ptr<RelayWorker>> workers;
+	for (int i = 0; i < options.threads; i++)
+		workers.push_back(std::make_unique<RelayWorker>());
+
+	std::vector<RelayGame> games;
+	games.reserve(options.games);
+	try {
+		for (int i = 0; i < options.games; i++) {
+			RelayGame game;
+			game.port = static_cast<unsigned short>(options.port + i);
+			if (options.hasPassword)
+				game.pktfty = std::make_unique<packet_factory>(options.password);
+			else
+				game.pktfty = std::make_unique<packet_factory>();
+			RelayWorker &worker = *workers[i % workers.size()];
+			game.server = std::make_unique<tcp_server>(worker.ioc, options.bindAddress, game.port, *game.pktfty,
+			    [&options]() { return MakeGameInfo(options); });
+			games.push_back(std::move(game));
+		}
+	} catch (std::exception &e) {
+		LogError("Failed to listen on {}:{}: {}", options.bindAddress, options.port + games.size(), e.what());
+		return 1;
+	}
+
+	for (auto &worker : workers) {
+		RelayWorker *w = worker.get();
+		w->thread = std::thread([w]() {
+			for (;;) {
+				try {
+					w->ioc.run();
+					return;
+				} catch (std::exception &e) {
+					// Errors are confined to the connection that raised them, keep serving the other games
+					LogError("Network error: {}", e.what());
+				}
+			}
+		});
+	}
+
+	Log("Hosting {} game(s) on {} ports {}-{} with {} thread(s)",
+	    games.size(), options.bindAddress, options.port, options.port + games.size() - 1, workers.size());
+
+	asio::io_context mainIoc;
+	asio::signal_set signals(mainIoc, SIGINT, SIGTERM);
+	signals.async_wait([&mainIoc](const asio::error_code &, int) {
+		mainIoc.stop();
+	});
+	StatsReporter reporter(mainIoc, games, options.statsInterval);
+	mainIoc.run();
+
+	Log("Shutting down");
+	for (auto &worker : workers) {
+		worker->ioc.stop();
+		worker->thread.join();
+	}
+	return 0;
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::net::RelayOptions options = devilution::net::ParseFlags(argc, argv);
+	return devilution::net::RunRelay(options);
+}
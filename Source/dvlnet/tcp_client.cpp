@@ -3,6 +3,7 @@
 #include "utils/language.h"
 
 #include <SDL.h>
+#include <array>
 #include <exception>
 #include <functional>
 #include <memory>
@@ -45,10 +46,9 @@ int tcp_client::join(std::string addrstr)
 	StartReceive();
 	{
 		cookie_self = packet_out::GenerateCookie();
-		auto pkt = pktfty->make_packet<PT_JOIN_REQUEST>(PLR_BROADCAST,
+		send(pktfty->make_packet<PT_JOIN_REQUEST>(PLR_BROADCAST,
 		    PLR_MASTER, cookie_self,
-		    game_init_info);
-		send(*pkt);
+		    game_init_info));
 		for (auto i = 0; i < NoSleep; ++i) {
 			try {
 				poll();
@@ -85,9 +85,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 	if (bytesRead == 0) {
 		throw std::runtime_error(_("error: read 0 bytes from server"));
 	}
-	recv_buffer.resize(bytesRead);
-	recv_queue.Write(std::move(recv_buffer));
-	recv_buffer.resize(frame_queue::max_frame_size);
+	recv_queue.Commit(bytesRead);
 	while (recv_queue.PacketReady()) {
 		auto pkt = pktfty->make_packet(recv_queue.ReadPacket());
 		RecvLocal(*pkt);
@@ -98,7 +96,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 void tcp_client::StartReceive()
 {
 	sock.async_receive(
-	    asio::buffer(recv_buffer),
+	    asio::buffer(recv_queue.Prepare(frame_queue::max_frame_size), frame_queue::max_frame_size),
 	    std::bind(&tcp_client::HandleReceive, this, std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -107,11 +105,12 @@ void tcp_client::HandleSend(const asio::error_code &error, size_t bytesSent)
 	// empty for now
 }
 
-void tcp_client::send(packet &pkt)
+void tcp_client::send(std::shared_ptr<packet> pkt)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
-	asio::async_write(sock, buf, [this, frame = std::move(frame)](const asio::error_code &error, size_t bytesSent) {
+	// Gather the size header and the packet data instead of copying them in to one frame
+	auto header = std::make_unique<framesize_t>(frame_queue::FrameSize(pkt->Data()));
+	std::array<asio::const_buffer, 2> bufs { asio::buffer(header.get(), sizeof(framesize_t)), asio::buffer(pkt->Data()) };
+	asio::async_write(sock, bufs, [this, header = std::move(header), pkt = std::move(pkt)](const asio::error_code &error, size_t bytesSent) {
 		HandleSend(error, bytesSent);
 	});
 }
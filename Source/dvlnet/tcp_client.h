@@ -22,7 +22,7 @@ public:
 	int join(std::string addrstr);
 
 	virtual void poll();
-	virtual void send(packet &pkt);
+	virtual void send(std::shared_ptr<packet> pkt);
 
 	virtual bool SNetLeaveGame(int type);
 
@@ -32,7 +32,6 @@ public:
 
 private:
 	frame_queue recv_queue;
-	buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
 
 	asio::io_context ioc;
 	asio::ip::tcp::resolver resolver = asio::ip::tcp::resolver(ioc);
@@ -12,9 +12,10 @@ namespace devilution {
 namespace net {
 
 tcp_server::tcp_server(asio::io_context &ioc, const std::string &bindaddr,
-    unsigned short port, packet_factory &pktfty)
+    unsigned short port, packet_factory &pktfty, game_info_factory makeGameInfo)
     : ioc(ioc)
     , pktfty(pktfty)
+    , make_game_info(std::move(makeGameInfo))
 {
 	auto addr = asio::ip::address::from_string(bindaddr);
 	auto ep = asio::ip::tcp::endpoint(addr, port);
@@ -37,6 +38,11 @@ std::string tcp_server::LocalhostSelf()
 	return addr.to_string();
 }
 
+unsigned short tcp_server::Port() const
+{
+	return acceptor->local_endpoint().port();
+}
+
 tcp_server::scc tcp_server::MakeConnection()
 {
 	return std::make_shared<client_connection>(ioc);
@@ -58,10 +64,19 @@ bool tcp_server::Empty()
 	return true;
 }
 
+void tcp_server::UpdatePlayerCount()
+{
+	uint32_t players = 0;
+	for (const scc &con : connections)
+		if (con)
+			players++;
+	stats.players.store(players, std::memory_order_relaxed);
+}
+
 void tcp_server::StartReceive(const scc &con)
 {
 	con->socket.async_receive(
-	    asio::buffer(con->recv_buffer),
+	    asio::buffer(con->recv_queue.Prepare(frame_queue::max_frame_size), frame_queue::max_frame_size),
 	    std::bind(&tcp_server::HandleReceive, this, con, std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -72,18 +87,17 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		DropConnection(con);
 		return;
 	}
-	con->recv_buffer.resize(bytesRead);
-	con->recv_queue.Write(std::move(con->recv_buffer));
-	con->recv_buffer.resize(frame_queue::max_frame_size);
+	stats.bytes_received.fetch_add(bytesRead, std::memory_order_relaxed);
+	con->recv_queue.Commit(bytesRead);
 	try {
 		while (con->recv_queue.PacketReady()) {
 			try {
-				auto pkt = pktfty.make_packet(con->recv_queue.ReadPacket());
+				std::shared_ptr<packet> pkt = pktfty.make_packet(con->recv_queue.ReadPacket());
 				if (con->plr == PLR_BROADCAST) {
 					HandleReceiveNewPlayer(con, *pkt);
 				} else {
 					con->timeout = timeout_active;
-					HandleReceivePacket(*pkt);
+					HandleReceivePacket(std::move(pkt));
 				}
 			} catch (dvlnet_exception &e) {
 				Log("Network error: {}", e.what());
@@ -101,9 +115,8 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 
 void tcp_server::SendConnect(const scc &con)
 {
-	auto pkt = pktfty.make_packet<PT_CONNECT>(PLR_MASTER, PLR_BROADCAST,
-	    con->plr);
-	SendPacket(*pkt);
+	SendPacket(pktfty.make_packet<PT_CONNECT>(PLR_MASTER, PLR_BROADCAST,
+	    con->plr));
 }
 
 void tcp_server::HandleReceiveNewPlayer(const scc &con, packet &pkt)
@@ -112,40 +125,58 @@ void tcp_server::HandleReceiveNewPlayer(const scc &con, packet &pkt)
 	if (newplr == PLR_BROADCAST)
 		throw server_exception();
 	if (Empty())
-		game_init_info = pkt.Info();
+		game_init_info = make_game_info ? make_game_info() : pkt.Info();
 	auto reply = pktfty.make_packet<PT_JOIN_ACCEPT>(PLR_MASTER, PLR_BROADCAST,
 	    pkt.Cookie(), newplr,
 	    game_init_info);
-	StartSend(con, *reply);
+	StartSend(con, std::move(reply));
 	con->plr = newplr;
 	connections[newplr] = con;
+	UpdatePlayerCount();
 	con->timeout = timeout_active;
 	SendConnect(con);
 }
 
-void tcp_server::HandleReceivePacket(packet &pkt)
+void tcp_server::HandleReceivePacket(std::shared_ptr<packet> pkt)
 {
-	SendPacket(pkt);
+	if (pkt->Type() == PT_TURN) {
+		stats.turns.fetch_add(1, std::memory_order_relaxed);
+	} else if (pkt->Type() == PT_BUNDLE) {
+		stats.turns.fetch_add(packet_factory::count_bundled(pkt->Bundle(), PT_TURN), std::memory_order_relaxed);
+	}
+	SendPacket(std::move(pkt));
 }
 
-void tcp_server::SendPacket(packet &pkt)
+void tcp_server::SendPacket(std::shared_ptr<packet> pkt)
 {
-	if (pkt.Destination() == PLR_BROADCAST) {
-		for (auto i = 0; i < MAX_PLRS; ++i)
-			if (i != pkt.Source() && connections[i])
-				StartSend(connections[i], pkt);
+	if (pkt->Destination() == PLR_BROADCAST) {
+		// All recipients share the same frame
+		std::shared_ptr<const send_frame> frame;
+		for (auto i = 0; i < MAX_PLRS; ++i) {
+			if (i == pkt->Source() || !connections[i])
+				continue;
+			if (!frame)
+				frame = std::make_shared<const send_frame>(send_frame { frame_queue::FrameSize(pkt->Data()), pkt });
+			StartSend(connections[i], frame);
+		}
 	} else {
-		if (pkt.Destination() >= MAX_PLRS)
+		if (pkt->Destination() >= MAX_PLRS)
 			throw server_exception();
-		if ((pkt.Destination() != pkt.Source()) && connections[pkt.Destination()])
-			StartSend(connections[pkt.Destination()], pkt);
+		if ((pkt->Destination() != pkt->Source()) && connections[pkt->Destination()])
+			StartSend(connections[pkt->Destination()], std::move(pkt));
 	}
 }
 
-void tcp_server::StartSend(const scc &con, packet &pkt)
+void tcp_server::StartSend(const scc &con, std::shared_ptr<packet> pkt)
+{
+	framesize_t header = frame_queue::FrameSize(pkt->Data());
+	StartSend(con, std::make_shared<const send_frame>(send_frame { header, std::move(pkt) }));
+}
+
+void tcp_server::StartSend(const scc &con, std::shared_ptr<const send_frame> frame)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
+	// The packet data is sent straight from the packet, only the size header is separate
+	std::array<asio::const_buffer, 2> buf { asio::buffer(&frame->header, sizeof(framesize_t)), asio::buffer(frame->pkt->Data()) };
 	asio::async_write(con->socket, buf,
 	    [this, con, frame = std::move(frame)](const asio::error_code &ec, size_t bytesSent) {
 		    HandleSend(con, ec, bytesSent);
@@ -155,7 +186,7 @@ void tcp_server::StartSend(const scc &con, packet &pkt)
 void tcp_server::HandleSend(const scc &con, const asio::error_code &ec,
     size_t bytesSent)
 {
-	// empty for now
+	stats.bytes_sent.fetch_add(bytesSent, std::memory_order_relaxed);
 }
 
 void tcp_server::StartAccept()
@@ -208,10 +239,11 @@ void tcp_server::HandleTimeout(const scc &con, const asio::error_code &ec)
 void tcp_server::DropConnection(const scc &con)
 {
 	if (con->plr != PLR_BROADCAST) {
-		auto pkt = pktfty.make_packet<PT_DISCONNECT>(PLR_MASTER, PLR_BROADCAST,
+		std::shared_ptr<packet> pkt = pktfty.make_packet<PT_DISCONNECT>(PLR_MASTER, PLR_BROADCAST,
 		    con->plr, LEAVE_DROP);
 		connections[con->plr] = nullptr;
-		SendPacket(*pkt);
+		UpdatePlayerCount();
+		SendPacket(std::move(pkt));
 		// TODO: investigate if it is really ok for the server to
 		//       drop a client directly.
 	}
@@ -224,6 +256,11 @@ void tcp_server::Close()
 	acceptor->close();
 }
 
+const tcp_server_stats &tcp_server::Stats() const
+{
+	return stats;
+}
+
 tcp_server::~tcp_server()
     = default;
 
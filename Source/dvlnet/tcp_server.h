@@ -1,6 +1,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -25,12 +28,37 @@ public:
 	}
 };
 
+/**
+ * @brief Traffic counters of a tcp_server
+ *
+ * Updated by the thread running the server's io_context, safe to read from any other thread.
+ */
+struct tcp_server_stats {
+	/** Number of players currently in the game */
+	std::atomic<uint32_t> players { 0 };
+	std::atomic<uint64_t> bytes_received { 0 };
+	std::atomic<uint64_t> bytes_sent { 0 };
+	/** Number of PT_TURN packets relayed */
+	std::atomic<uint64_t> turns { 0 };
+};
+
 class tcp_server {
 public:
+	/**
+	 * @brief Produces the GameData of a new game, for relays that host games no client created
+	 */
+	using game_info_factory = std::function<buffer_t()>;
+
+	/**
+	 * @param makeGameInfo Called when the first player joins an empty game. Without it the game
+	 * takes the info sent by the first player, which is the creating client when it hosts itself.
+	 */
 	tcp_server(asio::io_context &ioc, const std::string &bindaddr,
-	    unsigned short port, packet_factory &pktfty);
+	    unsigned short port, packet_factory &pktfty, game_info_factory makeGameInfo = nullptr);
 	std::string LocalhostSelf();
+	unsigned short Port() const;
 	void Close();
+	const tcp_server_stats &Stats() const;
 	virtual ~tcp_server();
 
 private:
@@ -39,7 +67,6 @@ private:
 
 	struct client_connection {
 		frame_queue recv_queue;
-		buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
 		plr_t plr = PLR_BROADCAST;
 		asio::ip::tcp::socket socket;
 		asio::steady_timer timer;
@@ -53,24 +80,38 @@ private:
 
 	typedef std::shared_ptr<client_connection> scc;
 
+	/**
+	 * @brief A packet and its size header, written together with a gather write
+	 *
+	 * Broadcasts share one frame between all recipients.
+	 */
+	struct send_frame {
+		framesize_t header;
+		std::shared_ptr<packet> pkt;
+	};
+
 	asio::io_context &ioc;
 	packet_factory &pktfty;
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::array<scc, MAX_PLRS> connections;
 	buffer_t game_init_info;
+	game_info_factory make_game_info;
+	tcp_server_stats stats;
 
 	scc MakeConnection();
 	plr_t NextFree();
 	bool Empty();
+	void UpdatePlayerCount();
 	void StartAccept();
 	void HandleAccept(const scc &con, const asio::error_code &ec);
 	void StartReceive(const scc &con);
 	void HandleReceive(const scc &con, const asio::error_code &ec, size_t bytesRead);
 	void HandleReceiveNewPlayer(const scc &con, packet &pkt);
-	void HandleReceivePacket(packet &pkt);
+	void HandleReceivePacket(std::shared_ptr<packet> pkt);
 	void SendConnect(const scc &con);
-	void SendPacket(packet &pkt);
-	void StartSend(const scc &con, packet &pkt);
+	void SendPacket(std::shared_ptr<packet> pkt);
+	void StartSend(const scc &con, std::shared_ptr<packet> pkt);
+	void StartSend(const scc &con, std::shared_ptr<const send_frame> frame);
 	void HandleSend(const scc &con, const asio::error_code &ec, size_t bytesSent);
 	void StartTimeout(const scc &con);
 	void HandleTimeout(const scc &con, const asio::error_code &ec);
@@ -7,12 +7,15 @@
 
 #include <SDL.h>
 
+#include "capture.h"
 #include "controls/plrctrls.h"
 #include "controls/touch/renderers.h"
 #include "engine.h"
+#include "nthread.h"
 #include "options.h"
 #include "utils/display.h"
 #include "utils/log.hpp"
+#include "utils/profiler.hpp"
 #include "utils/sdl_mutex.h"
 #include "utils/sdl_wrap.h"
 
@@ -34,6 +37,10 @@ unsigned int pal_surface_palette_version = 0;
 
 /** 24-bit renderer texture surface */
 SDLSurfaceUniquePtr RendererTextureSurface;
+#ifndef USE_SDL1
+/** 24-bit surface used instead of the window surface when rendering offscreen */
+SDLSurfaceUniquePtr OffscreenSurface;
+#endif
 
 /** 8-bit surface that we render to */
 SDL_Surface *PalSurface;
@@ -93,7 +100,7 @@ void UnlockBufPriv()
  */
 void LimitFrameRate()
 {
-	if (!*sgOptions.Graphics.limitFPS)
+	if (!*sgOptions.Graphics.limitFPS || nthread_is_fast_forward())
 		return;
 	static uint32_t frameDeadline;
 	uint32_t tc = SDL_GetTicks() * 1000;
@@ -162,8 +169,9 @@ void dx_cleanup()
 	Palette = nullptr;
 	RendererTextureSurface = nullptr;
 #ifndef USE_SDL1
+	OffscreenSurface = nullptr;
 	texture = nullptr;
-	if (*sgOptions.Graphics.upscale)
+	if (renderer != nullptr)
 		SDL_DestroyRenderer(renderer);
 #endif
 	SDL_DestroyWindow(ghMainWnd);
@@ -260,8 +268,15 @@ void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
 
 void RenderPresent()
 {
+	DVL_PROFILE_ZONE("RenderPresent");
 	SDL_Surface *surface = GetOutputSurface();
 
+	CaptureFrame();
+
+	// Nothing is shown, so there is no need to pace the frames either
+	if (IsOffscreenRendering())
+		return;
+
 	if (!gbActive) {
 		LimitFrameRate();
 		return;
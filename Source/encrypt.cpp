@@ -3,13 +3,16 @@
  *
  * Implementation of functions for compression and decompressing MPQ data.
  */
+#include <algorithm>
 #include <array>
 #include <cctype>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include <SDL.h>
 #include <pkware.h>
+#include <zlib.h>
 
 #include "encrypt.h"
 
@@ -38,6 +41,10 @@ void PkwareBufferWrite(char *buf, unsigned int *size, void *param) // NOLINT(rea
 {
 	auto *pInfo = reinterpret_cast<TDataInfo *>(param);
 
+	if (*size > pInfo->destSize - std::min(pInfo->destOffset, pInfo->destSize)) {
+		pInfo->destOffset = pInfo->destSize + 1;
+		return;
+	}
 	memcpy(pInfo->destData + pInfo->destOffset, buf, *size);
 	pInfo->destOffset += *size;
 }
@@ -57,6 +64,105 @@ const std::array<std::array<uint32_t, 256>, 5> hashtable = []() {
 	return ret;
 }();
 
+/**
+ * @brief Work memory for implode/explode, allocated once per thread
+ */
+char *PkwareWorkspace()
+{
+	thread_local std::unique_ptr<char[]> workspace { new char[std::max<size_t>(CMP_BUFFER_SIZE, EXP_BUFFER_SIZE)] };
+	return workspace.get();
+}
+
+/**
+ * @brief Intermediate output buffer of the codecs, grows as needed and is kept per thread
+ */
+byte *CodecScratch(size_t size)
+{
+	thread_local std::vector<byte> scratch;
+	if (scratch.size() < size)
+		scratch.resize(size);
+	return scratch.data();
+}
+
+/**
+ * @brief A deflate or inflate stream that is reset instead of reallocated between calls
+ */
+template <bool Inflate>
+class ZlibStream {
+public:
+	~ZlibStream()
+	{
+		if (!initialized_)
+			return;
+		if (Inflate)
+			inflateEnd(&stream_);
+		else
+			deflateEnd(&stream_);
+	}
+
+	/** @return The reset stream, or nullptr if zlib could not be initialized */
+	z_stream *Get()
+	{
+		if (initialized_) {
+			if ((Inflate ? inflateReset(&stream_) : deflateReset(&stream_)) != Z_OK)
+				return nullptr;
+			return &stream_;
+		}
+		stream_ = {};
+		if ((Inflate ? inflateInit(&stream_) : deflateInit(&stream_, Z_BEST_SPEED)) != Z_OK)
+			return nullptr;
+		initialized_ = true;
+		return &stream_;
+	}
+
+private:
+	z_stream stream_;
+	bool initialized_ = false;
+};
+
+uint32_t ZlibCompress(byte *srcData, uint32_t size)
+{
+	thread_local ZlibStream</*Inflate=*/false> deflater;
+	z_stream *stream = deflater.Get();
+	if (stream == nullptr)
+		return size;
+
+	uLong destSize = deflateBound(stream, size);
+	byte *destData = CodecScratch(destSize);
+	stream->next_in = reinterpret_cast<Bytef *>(srcData);
+	stream->avail_in = size;
+	stream->next_out = reinterpret_cast<Bytef *>(destData);
+	stream->avail_out = destSize;
+	if (deflate(stream, Z_FINISH) != Z_STREAM_END)
+		return size;
+
+	if (stream->total_out < size) {
+		memcpy(srcData, destData, stream->total_out);
+		size = stream->total_out;
+	}
+
+	return size;
+}
+
+bool ZlibDecompress(byte *inBuff, int recvSize, int maxBytes)
+{
+	thread_local ZlibStream</*Inflate=*/true> inflater;
+	z_stream *stream = inflater.Get();
+	if (stream == nullptr)
+		return false;
+
+	byte *outBuff = CodecScratch(maxBytes);
+	stream->next_in = reinterpret_cast<Bytef *>(inBuff);
+	stream->avail_in = recvSize;
+	stream->next_out = reinterpret_cast<Bytef *>(outBuff);
+	stream->avail_out = maxBytes;
+	if (inflate(stream, Z_FINISH) != Z_STREAM_END)
+		return false;
+
+	memcpy(inBuff, outBuff, stream->total_out);
+	return true;
+}
+
 } // namespace
 
 void Decrypt(uint32_t *castBlock, uint32_t size, uint32_t key)
@@ -103,48 +209,75 @@ uint32_t Hash(const char *s, int type)
 
 uint32_t PkwareCompress(byte *srcData, uint32_t size)
 {
-	std::unique_ptr<char[]> ptr { new char[CMP_BUFFER_SIZE] };
-
 	unsigned destSize = 2 * size;
 	if (destSize < 2 * 4096)
 		destSize = 2 * 4096;
 
-	std::unique_ptr<byte[]> destData { new byte[destSize] };
+	byte *destData = CodecScratch(destSize);
 
 	TDataInfo param;
 	param.srcData = srcData;
 	param.srcOffset = 0;
-	param.destData = destData.get();
+	param.destData = destData;
 	param.destOffset = 0;
 	param.size = size;
+	param.destSize = destSize;
 
 	unsigned type = 0;
 	unsigned dsize = 4096;
-	implode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &param, &type, &dsize);
+	implode(PkwareBufferRead, PkwareBufferWrite, PkwareWorkspace(), &param, &type, &dsize);
 
 	if (param.destOffset < size) {
-		memcpy(srcData, destData.get(), param.destOffset);
+		memcpy(srcData, destData, param.destOffset);
 		size = param.destOffset;
 	}
 
 	return size;
 }
 
-void PkwareDecompress(byte *inBuff, int recvSize, int maxBytes)
+bool PkwareDecompress(byte *inBuff, int recvSize, int maxBytes)
 {
 	TDataInfo info;
 
-	std::unique_ptr<char[]> ptr { new char[CMP_BUFFER_SIZE] };
-	std::unique_ptr<byte[]> outBuff { new byte[maxBytes] };
+	byte *outBuff = CodecScratch(maxBytes);
 
 	info.srcData = inBuff;
 	info.srcOffset = 0;
-	info.destData = outBuff.get();
+	info.destData = outBuff;
 	info.destOffset = 0;
 	info.size = recvSize;
+	info.destSize = maxBytes;
+
+	if (explode(PkwareBufferRead, PkwareBufferWrite, PkwareWorkspace(), &info) != CMP_NO_ERROR || info.destOffset > info.destSize)
+		return false;
+	memcpy(inBuff, outBuff, info.destOffset);
+	return true;
+}
+
+uint32_t CompressBuffer(CompressionCodec codec, byte *srcData, uint32_t size)
+{
+	switch (codec) {
+	case CompressionCodec::Pkware:
+		return PkwareCompress(srcData, size);
+	case CompressionCodec::Zlib:
+		return ZlibCompress(srcData, size);
+	default:
+		return size;
+	}
+}
 
-	explode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &info);
-	memcpy(inBuff, outBuff.get(), info.destOffset);
+bool DecompressBuffer(CompressionCodec codec, byte *inBuff, int recvSize, int maxBytes)
+{
+	switch (codec) {
+	case CompressionCodec::None:
+		return true;
+	case CompressionCodec::Pkware:
+		return PkwareDecompress(inBuff, recvSize, maxBytes);
+	case CompressionCodec::Zlib:
+		return ZlibDecompress(inBuff, recvSize, maxBytes);
+	default:
+		return false;
+	}
 }
 
 } // namespace devilution
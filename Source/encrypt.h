@@ -11,18 +11,49 @@
 
 namespace devilution {
 
+/**
+ * @brief Compression formats supported by CompressBuffer/DecompressBuffer
+ *
+ * The values are sent in front of compressed network payloads, do not reorder.
+ */
+enum class CompressionCodec : uint8_t {
+	None = 0,
+	/** PKWARE Data Compression Library implode, as used by the original game */
+	Pkware = 1,
+	/** Deflate at its fastest level, only used when the game creator announces it in GameData::deltaCodec */
+	Zlib = 2,
+};
+
 struct TDataInfo {
 	byte *srcData;
 	uint32_t srcOffset;
 	byte *destData;
 	uint32_t destOffset;
 	uint32_t size;
+	/** Capacity of destData, output beyond it is dropped and makes destOffset exceed it */
+	uint32_t destSize;
 };
 
 void Decrypt(uint32_t *castBlock, uint32_t size, uint32_t key);
 void Encrypt(uint32_t *castBlock, uint32_t size, uint32_t key);
 uint32_t Hash(const char *s, int type);
 uint32_t PkwareCompress(byte *srcData, uint32_t size);
-void PkwareDecompress(byte *inBuff, int recvSize, int maxBytes);
+/**
+ * @return false if the data is damaged or doesn't fit in maxBytes
+ */
+bool PkwareDecompress(byte *inBuff, int recvSize, int maxBytes);
+
+/**
+ * @brief Compress the buffer in place
+ * @return The new size, or size if compressing did not make the data smaller
+ */
+uint32_t CompressBuffer(CompressionCodec codec, byte *srcData, uint32_t size);
+
+/**
+ * @brief Decompress the buffer in place
+ * @param maxBytes Capacity of inBuff
+ * @return false if the codec is unknown, the data is damaged or doesn't fit in maxBytes
+ */
+bool DecompressBuffer(CompressionCodec codec, byte *inBuff, int recvSize, int maxBytes);
 
 } // namespace devilution
@@ -9,6 +9,7 @@
 #include "utils/file_util.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 
@@ -33,6 +34,7 @@ bool OpenMpqFile(const char *filename, MpqArchive **archive, uint32_t *fileNumbe
 
 SDL_RWops *OpenAsset(const char *filename, bool threadsafe)
 {
+	DVL_PROFILE_ZONE("OpenAsset");
 	std::string relativePath = filename;
 #ifndef _WIN32
 	std::replace(relativePath.begin(), relativePath.end(), '\\', '/');
@@ -0,0 +1,338 @@
+#include "engine/demo_file.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace devilution {
+
+namespace {
+
+/**
+ * Binary demos start with this magic followed by the version, save number, width and height.
+ *
+ * Every record starts with a tag byte: the DemoMsgType in bits 0-1 and in bits 2-3 how the
+ * progress to the next game tick is stored (ProgressEncoding). Messages continue with the
+ * message id, wParam and the difference to the lParam of the previous message, all as varints.
+ * State hashes continue with the number of hashes as a varint and each hash as 4 bytes.
+ */
+constexpr char Magic[4] = { 'D', 'V', 'L', 'D' };
+constexpr uint32_t BinaryVersion = 1;
+/** Version of the text format, which uses the version as first header field */
+constexpr int TextVersion = 0;
+
+constexpr size_t ChunkSize = 64 * 1024;
+
+enum class ProgressEncoding : uint8_t {
+	Zero = 0,
+	One = 1,
+	Repeat = 2,
+	Raw = 3,
+};
+
+int32_t ZigZagDecode(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (0 - (value & 1)));
+}
+
+uint32_t ZigZagEncode(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+void WriteVarint(std::vector<uint8_t> &buffer, uint32_t value)
+{
+	while (value >= 0x80) {
+		buffer.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void WriteUint32(std::vector<uint8_t> &buffer, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+} // namespace
+
+bool DemoReader::Open(const std::string &path, DemoHeader &header)
+{
+	Close();
+	file_.open(path, std::ios::in | std::ios::binary);
+	if (!file_.is_open())
+		return false;
+
+	Fill();
+	binary_ = buffer_.size() >= sizeof(Magic) && std::memcmp(buffer_.data(), Magic, sizeof(Magic)) == 0;
+	if (binary_) {
+		pos_ = sizeof(Magic);
+		uint32_t version;
+		uint32_t saveNumber;
+		uint32_t width;
+		uint32_t height;
+		if (!ReadVarint(version) || version != BinaryVersion)
+			return false;
+		if (!ReadVarint(saveNumber) || !ReadVarint(width) || !ReadVarint(height))
+			return false;
+		header.saveNumber = ZigZagDecode(saveNumber);
+		header.width = static_cast<int>(width);
+		header.height = static_cast<int>(height);
+		return true;
+	}
+
+	std::string line;
+	if (!ReadLine(line))
+		return false;
+	char *field = &line[0];
+	if (std::strtol(field, &field, 10) != TextVersion || *field != ',')
+		return false;
+	header.saveNumber = std::strtol(field + 1, &field, 10);
+	header.width = std::strtol(field + 1, &field, 10);
+	header.height = std::strtol(field + 1, &field, 10);
+	return true;
+}
+
+void DemoReader::Close()
+{
+	file_.close();
+	file_.clear();
+	buffer_.clear();
+	pos_ = 0;
+	hasNext_ = false;
+	lastProgress_ = 0;
+	lastLParam_ = 0;
+}
+
+bool DemoReader::Peek(DemoMessage &msg)
+{
+	if (!hasNext_) {
+		if (!file_.is_open())
+			return false;
+		hasNext_ = binary_ ? ReadBinary(next_) : ReadText(next_);
+		if (!hasNext_)
+			return false;
+	}
+	msg = next_;
+	return true;
+}
+
+void DemoReader::Pop()
+{
+	hasNext_ = false;
+}
+
+bool DemoReader::Fill()
+{
+	buffer_.erase(buffer_.begin(), buffer_.begin() + pos_);
+	pos_ = 0;
+	const size_t size = buffer_.size();
+	buffer_.resize(size + ChunkSize);
+	file_.read(reinterpret_cast<char *>(&buffer_[size]), ChunkSize);
+	buffer_.resize(size + file_.gcount());
+	return file_.gcount() > 0;
+}
+
+bool DemoReader::ReadByte(uint8_t &value)
+{
+	if (pos_ == buffer_.size() && !Fill())
+		return false;
+	value = buffer_[pos_++];
+	return true;
+}
+
+bool DemoReader::ReadVarint(uint32_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		uint8_t byte;
+		if (!ReadByte(byte))
+			return false;
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+bool DemoReader::ReadUint32(uint32_t &value)
+{
+	value = 0;
+	for (int i = 0; i < 4; i++) {
+		uint8_t byte;
+		if (!ReadByte(byte))
+			return false;
+		value |= static_cast<uint32_t>(byte) << (8 * i);
+	}
+	return true;
+}
+
+bool DemoReader::ReadStateHashes(StateHashes &hashes)
+{
+	uint32_t count;
+	if (!ReadVarint(count))
+		return false;
+	hashes.fill(0);
+	// Hashes of subsystems this build doesn't know about are skipped
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t hash;
+		if (!ReadUint32(hash))
+			return false;
+		if (i < hashes.size())
+			hashes[i] = hash;
+	}
+	return true;
+}
+
+bool DemoReader::ReadLine(std::string &line)
+{
+	line.clear();
+	while (true) {
+		auto begin = buffer_.begin() + pos_;
+		auto end = std::find(begin, buffer_.end(), '\n');
+		line.append(begin, end);
+		if (end != buffer_.end()) {
+			pos_ = end - buffer_.begin() + 1;
+			return true;
+		}
+		pos_ = buffer_.size();
+		if (!Fill())
+			return !line.empty();
+	}
+}
+
+bool DemoReader::ReadBinary(DemoMessage &msg)
+{
+	uint8_t tag;
+	if (!ReadByte(tag))
+		return false;
+	msg.type = static_cast<DemoMsgType>(tag & 3);
+	switch (static_cast<ProgressEncoding>((tag >> 2) & 3)) {
+	case ProgressEncoding::Zero:
+		msg.progressToNextGameTick = 0;
+		break;
+	case ProgressEncoding::One:
+		msg.progressToNextGameTick = 1;
+		break;
+	case ProgressEncoding::Repeat:
+		msg.progressToNextGameTick = lastProgress_;
+		break;
+	case ProgressEncoding::Raw: {
+		uint32_t bits;
+		if (!ReadUint32(bits))
+			return false;
+		std::memcpy(&msg.progressToNextGameTick, &bits, sizeof(bits));
+		break;
+	}
+	}
+	lastProgress_ = msg.progressToNextGameTick;
+
+	msg.message = 0;
+	msg.wParam = 0;
+	msg.lParam = 0;
+	if (msg.type == DemoMsgType::StateHash)
+		return ReadStateHashes(msg.hashes);
+	if (msg.type != DemoMsgType::Message)
+		return true;
+
+	uint32_t wParam;
+	uint32_t lParamDelta;
+	if (!ReadVarint(msg.message) || !ReadVarint(wParam) || !ReadVarint(lParamDelta))
+		return false;
+	msg.wParam = ZigZagDecode(wParam);
+	msg.lParam = static_cast<int32_t>(static_cast<uint32_t>(lastLParam_) + static_cast<uint32_t>(ZigZagDecode(lParamDelta)));
+	lastLParam_ = msg.lParam;
+	return true;
+}
+
+bool DemoReader::ReadText(DemoMessage &msg)
+{
+	std::string line;
+	do {
+		if (!ReadLine(line))
+			return false;
+	} while (line.empty() || line == "\r");
+
+	char *field = &line[0];
+	msg.type = static_cast<DemoMsgType>(std::strtol(field, &field, 10));
+	msg.progressToNextGameTick = std::strtof(field + 1, &field);
+	msg.message = 0;
+	msg.wParam = 0;
+	msg.lParam = 0;
+	if (msg.type == DemoMsgType::Message) {
+		msg.message = std::strtoul(field + 1, &field, 10);
+		msg.wParam = std::strtol(field + 1, &field, 10);
+		msg.lParam = std::strtol(field + 1, &field, 10);
+	}
+	return true;
+}
+
+bool DemoWriter::Open(const std::string &path, const DemoHeader &header)
+{
+	Close();
+	file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file_.is_open())
+		return false;
+
+	buffer_.reserve(ChunkSize + 32);
+	buffer_.insert(buffer_.end(), Magic, Magic + sizeof(Magic));
+	WriteVarint(buffer_, BinaryVersion);
+	WriteVarint(buffer_, ZigZagEncode(header.saveNumber));
+	WriteVarint(buffer_, header.width);
+	WriteVarint(buffer_, header.height);
+	lastProgress_ = 0;
+	lastLParam_ = 0;
+	return true;
+}
+
+void DemoWriter::Write(const DemoMessage &msg)
+{
+	ProgressEncoding progress = ProgressEncoding::Raw;
+	if (msg.progressToNextGameTick == 0)
+		progress = ProgressEncoding::Zero;
+	else if (msg.progressToNextGameTick == 1)
+		progress = ProgressEncoding::One;
+	else if (msg.progressToNextGameTick == lastProgress_)
+		progress = ProgressEncoding::Repeat;
+	lastProgress_ = msg.progressToNextGameTick;
+
+	buffer_.push_back(static_cast<uint8_t>(msg.type) | (static_cast<uint8_t>(progress) << 2));
+	if (progress == ProgressEncoding::Raw) {
+		uint32_t bits;
+		std::memcpy(&bits, &msg.progressToNextGameTick, sizeof(bits));
+		WriteUint32(buffer_, bits);
+	}
+
+	if (msg.type == DemoMsgType::StateHash) {
+		WriteVarint(buffer_, static_cast<uint32_t>(msg.hashes.size()));
+		for (uint32_t hash : msg.hashes)
+			WriteUint32(buffer_, hash);
+	}
+
+	if (msg.type == DemoMsgType::Message) {
+		WriteVarint(buffer_, msg.message);
+		WriteVarint(buffer_, ZigZagEncode(msg.wParam));
+		WriteVarint(buffer_, ZigZagEncode(static_cast<int32_t>(static_cast<uint32_t>(msg.lParam) - static_cast<uint32_t>(lastLParam_))));
+		lastLParam_ = msg.lParam;
+	}
+
+	if (buffer_.size() >= ChunkSize)
+		Flush();
+}
+
+void DemoWriter::Close()
+{
+	if (!file_.is_open())
+		return;
+	Flush();
+	file_.close();
+}
+
+void DemoWriter::Flush()
+{
+	file_.write(reinterpret_cast<const char *>(buffer_.data()), buffer_.size());
+	buffer_.clear();
+}
+
+} // namespace devilution
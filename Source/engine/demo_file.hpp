@@ -0,0 +1,118 @@
+/**
+ * @file demo_file.hpp
+ *
+ * Streaming reader and writer for demo recordings.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "engine/state_hash.hpp"
+
+namespace devilution {
+
+enum class DemoMsgType : uint8_t {
+	GameTick = 0,
+	Rendering = 1,
+	Message = 2,
+	/** Checksums of the simulation state after the preceding game tick */
+	StateHash = 3,
+};
+
+struct DemoMessage {
+	DemoMsgType type;
+	uint32_t message;
+	int32_t wParam;
+	int32_t lParam;
+	float progressToNextGameTick;
+	/** Only used by StateHash records */
+	StateHashes hashes;
+};
+
+struct DemoHeader {
+	int saveNumber;
+	int width;
+	int height;
+};
+
+/**
+ * @brief Reads a demo one record at a time
+ *
+ * Reads the binary format as well as the text format of older recordings. Only a small window
+ * of the file is held in memory.
+ */
+class DemoReader {
+public:
+	/**
+	 * @return false if the file can't be opened or has an unsupported version
+	 */
+	bool Open(const std::string &path, DemoHeader &header);
+	void Close();
+
+	/**
+	 * @brief Get the next record without consuming it
+	 * @return false at the end of the demo
+	 */
+	bool Peek(DemoMessage &msg);
+	void Pop();
+
+private:
+	std::ifstream file_;
+	bool binary_ = false;
+	/** Window of the file that is being decoded */
+	std::vector<uint8_t> buffer_;
+	size_t pos_ = 0;
+	bool hasNext_ = false;
+	DemoMessage next_;
+	float lastProgress_ = 0;
+	int32_t lastLParam_ = 0;
+
+	/**
+	 * @brief Drop the consumed part of the window and read the next chunk of the file
+	 * @return false at the end of the file
+	 */
+	bool Fill();
+	bool ReadByte(uint8_t &value);
+	bool ReadVarint(uint32_t &value);
+	bool ReadUint32(uint32_t &value);
+	bool ReadStateHashes(StateHashes &hashes);
+	bool ReadLine(std::string &line);
+	bool ReadBinary(DemoMessage &msg);
+	bool ReadText(DemoMessage &msg);
+};
+
+/**
+ * @brief Writes a demo in the binary format
+ *
+ * Records are collected in a buffer and written in large blocks.
+ */
+class DemoWriter {
+public:
+	bool Open(const std::string &path, const DemoHeader &header);
+	void Write(const DemoMessage &msg);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return file_.is_open();
+	}
+
+	~DemoWriter()
+	{
+		Close();
+	}
+
+private:
+	std::ofstream file_;
+	std::vector<uint8_t> buffer_;
+	float lastProgress_ = 0;
+	int32_t lastLParam_ = 0;
+
+	void Flush();
+};
+
+} // namespace devilution
@@ -1,9 +1,15 @@
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <fstream>
-#include <iostream>
-#include <sstream>
+#include <vector>
+
+#include <fmt/format.h>
 
 #include "demomode.h"
+#include "diablo.h"
+#include "engine/demo_file.hpp"
+#include "engine/state_hash.hpp"
 #include "menu.h"
 #include "nthread.h"
 #include "options.h"
@@ -15,26 +21,12 @@ namespace devilution {
 
 namespace {
 
-enum class DemoMsgType {
-	GameTick = 0,
-	Rendering = 1,
-	Message = 2,
-};
-
-struct demoMsg {
-	DemoMsgType type;
-	uint32_t message;
-	int32_t wParam;
-	int32_t lParam;
-	float progressToNextGameTick;
-};
-
 int DemoNumber = -1;
 bool Timedemo = false;
 int RecordNumber = -1;
 
-std::ofstream DemoRecording;
-std::deque<demoMsg> Demo_Message_Queue;
+DemoWriter DemoRecording;
+DemoReader DemoPlayback;
 uint32_t DemoModeLastTick = 0;
 
 int LogicTick = 0;
@@ -43,98 +35,160 @@ int StartTime = 0;
 int DemoGraphicsWidth = 640;
 int DemoGraphicsHeight = 480;
 
-void PumpDemoMessage(DemoMsgType demoMsgType, uint32_t message, int32_t wParam, int32_t lParam, float progressToNextGameTick)
+/** Record the state hashes after each game tick */
+bool RecordStateHashes = false;
+/** Game ticks of the playback whose state hashes were compared */
+int VerifiedTicks = 0;
+int DivergedTicks = 0;
+
+struct TimingStats {
+	size_t count;
+	double totalMs;
+	double meanUs;
+	double p50Us;
+	double p90Us;
+	double p99Us;
+	double maxUs;
+};
+
+/** Where the timing report is written, empty if timing is disabled */
+std::string TimingReportPath;
+/** Duration of each game logic step in nanoseconds, only for ticks in which the step ran */
+std::array<std::vector<uint32_t>, NumGameLogicSteps> StepTimings;
+std::vector<uint32_t> TickTimings;
+std::vector<uint32_t> FrameTimings;
+std::array<uint32_t, NumGameLogicSteps> CurrentTickSteps;
+std::array<bool, NumGameLogicSteps> CurrentTickRan;
+GameLogicStep CurrentStep;
+uint64_t StepStart;
+uint64_t TickStart;
+uint64_t FrameStart;
+
+uint64_t TimerNs()
 {
-	demoMsg msg;
-	msg.type = demoMsgType;
-	msg.message = message;
-	msg.wParam = wParam;
-	msg.lParam = lParam;
-	msg.progressToNextGameTick = progressToNextGameTick;
-
-	Demo_Message_Queue.push_back(msg);
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
 }
 
-bool LoadDemoMessages(int i)
+uint32_t ElapsedNs(uint64_t start, uint64_t end)
 {
-	std::ifstream demofile;
-	char demoFilename[16];
-	snprintf(demoFilename, 15, "demo_%d.dmo", i);
-	demofile.open(paths::PrefPath() + demoFilename);
-	if (!demofile.is_open()) {
-		return false;
-	}
+	return static_cast<uint32_t>(std::min<uint64_t>(end - start, UINT32_MAX));
+}
 
-	std::string line;
-	std::getline(demofile, line);
-	std::stringstream header(line);
+TimingStats ComputeStats(std::vector<uint32_t> &samples)
+{
+	TimingStats stats {};
+	stats.count = samples.size();
+	if (samples.empty())
+		return stats;
+	std::sort(samples.begin(), samples.end());
+	uint64_t total = 0;
+	for (uint32_t sample : samples)
+		total += sample;
+	auto percentile = [&](size_t percent) {
+		return samples[(samples.size() - 1) * percent / 100] / 1000.0;
+	};
+	stats.totalMs = total / 1000000.0;
+	stats.meanUs = total / 1000.0 / samples.size();
+	stats.p50Us = percentile(50);
+	stats.p90Us = percentile(90);
+	stats.p99Us = percentile(99);
+	stats.maxUs = samples.back() / 1000.0;
+	return stats;
+}
 
-	std::string number;
-	std::getline(header, number, ','); // Demo version
-	if (std::stoi(number) != 0) {
-		return false;
+void WriteTimingReport(float seconds)
+{
+	std::vector<std::pair<std::string, TimingStats>> rows;
+	rows.emplace_back("Tick", ComputeStats(TickTimings));
+	for (size_t i = 0; i < NumGameLogicSteps; i++) {
+		if (!StepTimings[i].empty())
+			rows.emplace_back(GameLogicStepName(static_cast<GameLogicStep>(i)), ComputeStats(StepTimings[i]));
 	}
-
-	std::getline(header, number, ',');
-	gSaveNumber = std::stoi(number);
-
-	std::getline(header, number, ',');
-	DemoGraphicsWidth = std::stoi(number);
-
-	std::getline(header, number, ',');
-	DemoGraphicsHeight = std::stoi(number);
-
-	while (std::getline(demofile, line)) {
-		std::stringstream command(line);
-
-		std::getline(command, number, ',');
-		int typeNum = std::stoi(number);
-		auto type = static_cast<DemoMsgType>(typeNum);
-
-		std::getline(command, number, ',');
-		float progressToNextGameTick = std::stof(number);
-
-		switch (type) {
-		case DemoMsgType::Message: {
-			std::getline(command, number, ',');
-			uint32_t message = std::stoi(number);
-			std::getline(command, number, ',');
-			int32_t wParam = std::stoi(number);
-			std::getline(command, number, ',');
-			int32_t lParam = std::stoi(number);
-			PumpDemoMessage(type, message, wParam, lParam, progressToNextGameTick);
-			break;
+	rows.emplace_back("Frame", ComputeStats(FrameTimings));
+
+	const bool json = TimingReportPath.size() >= 5 && TimingReportPath.compare(TimingReportPath.size() - 5, 5, ".json") == 0;
+	std::string report;
+	if (json) {
+		report = fmt::format("{{\n  \"demo\": {},\n  \"ticks\": {},\n  \"frames\": {},\n  \"seconds\": {:.3f},\n  \"timings\": {{",
+		    DemoNumber, TickTimings.size(), FrameTimings.size(), seconds);
+		for (size_t i = 0; i < rows.size(); i++) {
+			const TimingStats &stats = rows[i].second;
+			report += fmt::format("{}\n    \"{}\": {{ \"count\": {}, \"total_ms\": {:.3f}, \"mean_us\": {:.1f}, \"p50_us\": {:.1f}, \"p90_us\": {:.1f}, \"p99_us\": {:.1f}, \"max_us\": {:.1f} }}",
+			    i == 0 ? "" : ",", rows[i].first, stats.count, stats.totalMs, stats.meanUs, stats.p50Us, stats.p90Us, stats.p99Us, stats.maxUs);
 		}
-		default:
-			PumpDemoMessage(type, 0, 0, 0, progressToNextGameTick);
-			break;
+		report += "\n  }\n}\n";
+	} else {
+		report = "name,count,total_ms,mean_us,p50_us,p90_us,p99_us,max_us\n";
+		for (auto &row : rows) {
+			const TimingStats &stats = row.second;
+			report += fmt::format("{},{},{:.3f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f}\n",
+			    row.first, stats.count, stats.totalMs, stats.meanUs, stats.p50Us, stats.p90Us, stats.p99Us, stats.maxUs);
 		}
 	}
 
-	demofile.close();
+	std::ofstream file(TimingReportPath, std::ios::out | std::ios::trunc);
+	file << report;
+	if (!file)
+		SDL_Log("Unable to write timing report to %s", TimingReportPath.c_str());
+}
+
+std::string DemoFilePath(int i)
+{
+	char demoFilename[16];
+	snprintf(demoFilename, 15, "demo_%d.dmo", i);
+	return paths::PrefPath() + demoFilename;
+}
+
+/**
+ * @brief Open the demo for playback, the records are read while the demo is played
+ */
+bool LoadDemoMessages(int i)
+{
+	DemoHeader header;
+	if (!DemoPlayback.Open(DemoFilePath(i), header))
+		return false;
+
+	gSaveNumber = header.saveNumber;
+	DemoGraphicsWidth = header.width;
+	DemoGraphicsHeight = header.height;
 
 	DemoModeLastTick = SDL_GetTicks();
 
 	return true;
 }
 
+void RecordDemoMessage(DemoMsgType type, uint32_t message, int32_t wParam, int32_t lParam)
+{
+	if (!DemoRecording.IsOpen())
+		return;
+	DemoRecording.Write({ type, message, wParam, lParam, gfProgressToNextGameTick });
+}
+
 } // namespace
 
 namespace demo {
 
-void InitPlayBack(int demoNumber, bool timedemo)
+void InitPlayBack(int demoNumber, bool timedemo, bool headless)
 {
 	DemoNumber = demoNumber;
 	Timedemo = timedemo;
+	if (headless)
+		InitOffscreenRendering();
 
 	if (!LoadDemoMessages(demoNumber)) {
 		SDL_Log("Unable to load demo file");
 		diablo_quit(1);
 	}
 }
-void InitRecording(int recordNumber)
+void InitRecording(int recordNumber, bool stateHashes)
 {
 	RecordNumber = recordNumber;
+	RecordStateHashes = stateHashes;
+}
+void InitTimingReport(std::string path)
+{
+	TimingReportPath = std::move(path);
 }
 void OverrideOptions()
 {
@@ -164,9 +218,15 @@ bool IsRecording()
 
 bool GetRunGameLoop(bool &drawGame, bool &processInput)
 {
-	if (Demo_Message_Queue.empty())
+	DemoMessage dmsg;
+	if (!DemoPlayback.Peek(dmsg))
 		app_fatal("Demo queue empty");
-	demoMsg dmsg = Demo_Message_Queue.front();
+	while (dmsg.type == DemoMsgType::StateHash) {
+		// Left over from a tick that didn't run the game logic
+		DemoPlayback.Pop();
+		if (!DemoPlayback.Peek(dmsg))
+			app_fatal("Demo queue empty");
+	}
 	if (dmsg.type == DemoMsgType::Message)
 		app_fatal("Unexpected Message");
 	if (Timedemo) {
@@ -193,7 +253,7 @@ bool GetRunGameLoop(bool &drawGame, bool &processInput)
 		}
 	}
 	gfProgressToNextGameTick = dmsg.progressToNextGameTick;
-	Demo_Message_Queue.pop_front();
+	DemoPlayback.Pop();
 	if (dmsg.type == DemoMsgType::GameTick)
 		LogicTick++;
 	return dmsg.type == DemoMsgType::GameTick;
@@ -210,7 +270,7 @@ bool FetchMessage(tagMSG *lpMsg)
 			return true;
 		}
 		if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
-			Demo_Message_Queue.clear();
+			DemoPlayback.Close();
 			ClearMessageQueue();
 			DemoNumber = -1;
 			Timedemo = false;
@@ -228,16 +288,14 @@ bool FetchMessage(tagMSG *lpMsg)
 		}
 	}
 
-	if (!Demo_Message_Queue.empty()) {
-		demoMsg dmsg = Demo_Message_Queue.front();
-		if (dmsg.type == DemoMsgType::Message) {
-			lpMsg->message = dmsg.message;
-			lpMsg->lParam = dmsg.lParam;
-			lpMsg->wParam = dmsg.wParam;
-			gfProgressToNextGameTick = dmsg.progressToNextGameTick;
-			Demo_Message_Queue.pop_front();
-			return true;
-		}
+	DemoMessage dmsg;
+	if (DemoPlayback.Peek(dmsg) && dmsg.type == DemoMsgType::Message) {
+		lpMsg->message = dmsg.message;
+		lpMsg->lParam = dmsg.lParam;
+		lpMsg->wParam = dmsg.wParam;
+		gfProgressToNextGameTick = dmsg.progressToNextGameTick;
+		DemoPlayback.Pop();
+		return true;
 	}
 
 	lpMsg->message = 0;
@@ -249,47 +307,132 @@ bool FetchMessage(tagMSG *lpMsg)
 
 void RecordGameLoopResult(bool runGameLoop)
 {
-	DemoRecording << static_cast<uint32_t>(runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering) << "," << gfProgressToNextGameTick << "\n";
+	RecordDemoMessage(runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering, 0, 0, 0);
 }
 
 void RecordMessage(tagMSG *lpMsg)
 {
-	if (!gbRunGame || !DemoRecording.is_open())
+	if (!gbRunGame)
 		return;
-	DemoRecording << static_cast<uint32_t>(DemoMsgType::Message) << "," << gfProgressToNextGameTick << "," << lpMsg->message << "," << lpMsg->wParam << "," << lpMsg->lParam << "\n";
+	RecordDemoMessage(DemoMsgType::Message, lpMsg->message, lpMsg->wParam, lpMsg->lParam);
 }
 
 void NotifyGameLoopStart()
 {
 	if (IsRecording()) {
-		char demoFilename[16];
-		snprintf(demoFilename, 15, "demo_%d.dmo", RecordNumber);
-		DemoRecording.open(paths::PrefPath() + demoFilename, std::fstream::trunc);
-		DemoRecording << "0," << gSaveNumber << "," << gnScreenWidth << "," << gnScreenHeight << "\n";
+		if (!DemoRecording.Open(DemoFilePath(RecordNumber), { gSaveNumber, gnScreenWidth, gnScreenHeight }))
+			SDL_Log("Unable to create demo file");
 	}
 
 	if (IsRunning()) {
 		StartTime = SDL_GetTicks();
 		LogicTick = 0;
+		VerifiedTicks = 0;
+		DivergedTicks = 0;
 	}
 }
 
+void NotifyGameLogicEnd()
+{
+	if (IsRecording() && RecordStateHashes && DemoRecording.IsOpen()) {
+		DemoMessage msg { DemoMsgType::StateHash, 0, 0, 0, gfProgressToNextGameTick };
+		msg.hashes = ComputeStateHashes();
+		DemoRecording.Write(msg);
+	}
+
+	DemoMessage dmsg;
+	if (!IsRunning() || !DemoPlayback.Peek(dmsg) || dmsg.type != DemoMsgType::StateHash)
+		return;
+	DemoPlayback.Pop();
+
+	const StateHashes hashes = ComputeStateHashes();
+	VerifiedTicks++;
+	if (hashes == dmsg.hashes)
+		return;
+	DivergedTicks++;
+	if (DivergedTicks != 1)
+		return;
+	std::string subsystems;
+	for (size_t i = 0; i < hashes.size(); i++) {
+		if (hashes[i] == dmsg.hashes[i])
+			continue;
+		if (!subsystems.empty())
+			subsystems += ", ";
+		subsystems += StateHashSubsystemName(static_cast<StateHashSubsystem>(i));
+	}
+	SDL_Log("Demo diverged at game tick %d: %s", LogicTick, subsystems.c_str());
+}
+
 void NotifyGameLoopEnd()
 {
 	if (IsRecording()) {
-		DemoRecording.close();
+		DemoRecording.Close();
 
 		RecordNumber = -1;
 	}
 
 	if (IsRunning()) {
+		DemoPlayback.Close();
 		float secounds = (SDL_GetTicks() - StartTime) / 1000.0;
 		SDL_Log("%d frames, %.2f seconds: %.1f fps", LogicTick, secounds, LogicTick / secounds);
+		if (IsTiming())
+			WriteTimingReport(secounds);
+		if (VerifiedTicks != 0)
+			SDL_Log("State hashes: %d game ticks verified, %d diverged", VerifiedTicks, DivergedTicks);
 		gbRunGameResult = false;
 		gbRunGame = false;
 	}
 }
 
+bool StateHashesDiverged()
+{
+	return DivergedTicks != 0;
+}
+
+bool IsTiming()
+{
+	return IsRunning() && !TimingReportPath.empty();
+}
+
+void TimeTickStart()
+{
+	CurrentTickSteps.fill(0);
+	CurrentTickRan.fill(false);
+	CurrentStep = GameLogicStep::None;
+	TickStart = TimerNs();
+	StepStart = TickStart;
+}
+
+void TimeGameLogicStep(GameLogicStep step)
+{
+	const uint64_t now = TimerNs();
+	const auto current = static_cast<size_t>(CurrentStep);
+	CurrentTickSteps[current] += ElapsedNs(StepStart, now);
+	CurrentTickRan[current] = true;
+	CurrentStep = step;
+	StepStart = now;
+}
+
+void TimeTickEnd()
+{
+	TimeGameLogicStep(GameLogicStep::None);
+	TickTimings.push_back(ElapsedNs(TickStart, StepStart));
+	for (size_t i = 0; i < NumGameLogicSteps; i++) {
+		if (CurrentTickRan[i])
+			StepTimings[i].push_back(CurrentTickSteps[i]);
+	}
+}
+
+void TimeFrameStart()
+{
+	FrameStart = TimerNs();
+}
+
+void TimeFrameEnd()
+{
+	FrameTimings.push_back(ElapsedNs(FrameStart, TimerNs()));
+}
+
 } // namespace demo
 
 } // namespace devilution
@@ -5,14 +5,30 @@
  */
 #pragma once
 
+#include <string>
+
 #include "miniwin/miniwin.h"
 
 namespace devilution {
 
+enum class GameLogicStep;
+
 namespace demo {
 
-void InitPlayBack(int demoNumber, bool timedemo);
-void InitRecording(int recordNumber);
+/**
+ * @param headless Render offscreen, see InitOffscreenRendering
+ */
+void InitPlayBack(int demoNumber, bool timedemo, bool headless);
+/**
+ * @param stateHashes Store checksums of the simulation state after every game tick, playback compares them
+ */
+void InitRecording(int recordNumber, bool stateHashes);
+/**
+ * @brief Time every game logic step and frame during playback and write a report to the given path
+ *
+ * The report is JSON if the path ends in .json and CSV otherwise.
+ */
+void InitTimingReport(std::string path);
 void OverrideOptions();
 
 bool IsRunning();
@@ -25,6 +41,24 @@ void RecordMessage(tagMSG *lpMsg);
 
 void NotifyGameLoopStart();
 void NotifyGameLoopEnd();
+/**
+ * @brief Records or verifies the state hashes of the game tick that just ran
+ */
+void NotifyGameLogicEnd();
+/**
+ * @return true if the state of a played back demo didn't match the recorded state hashes
+ */
+bool StateHashesDiverged();
+
+bool IsTiming();
+void TimeTickStart();
+/**
+ * @brief Ends the timing of the current game logic step and starts timing the given one
+ */
+void TimeGameLogicStep(GameLogicStep step);
+void TimeTickEnd();
+void TimeFrameStart();
+void TimeFrameEnd();
 
 } // namespace demo
 
@@ -8,6 +8,7 @@
 #include "appfat.h"
 #include "diablo.h"
 #include "engine/assets.hpp"
+#include "utils/profiler.hpp"
 #include "utils/stdcompat/cstddef.hpp"
 
 namespace devilution {
@@ -42,6 +43,7 @@ public:
 
 	bool Read(void *buffer, std::size_t len) const
 	{
+		DVL_PROFILE_ZONE("ReadAsset");
 		return SDL_RWread(handle_, buffer, len, 1);
 	}
 
@@ -20,6 +20,7 @@
 #include "palette.h"
 #include "utils/display.h"
 #include "utils/language.h"
+#include "utils/memory_stats.hpp"
 #include "utils/sdl_compat.h"
 #include "utils/utf8.hpp"
 
@@ -127,6 +128,14 @@ bool IsSmallFontTallRow(uint16_t row)
 	return IsCJK(row) || IsHangul(row);
 }
 
+/** Size of the pixels of a loaded font, for memory accounting */
+std::ptrdiff_t FontSurfaceBytes(const Art &font)
+{
+	if (font.surface == nullptr)
+		return 0;
+	return static_cast<std::ptrdiff_t>(font.surface->pitch) * font.surface->h;
+}
+
 std::array<uint8_t, 256> *LoadFontKerning(GameFontTables size, uint16_t row)
 {
 	uint32_t fontId = (size << 16) | row;
@@ -136,6 +145,8 @@ std::array<uint8_t, 256> *LoadFontKerning(GameFontTables size, uint16_t row)
 		return &hotKerning->second;
 	}
 
+	MemoryCategoryScope memoryScope(MemoryCategory::Fonts);
+
 	char path[32];
 	sprintf(path, "fonts\\%i-%02x.bin", FontSizes[size], row);
 
@@ -171,6 +182,7 @@ Art *LoadFont(GameFontTables size, text_color color, uint16_t row)
 	char path[32];
 	sprintf(path, "fonts\\%i-%02x.pcx", FontSizes[size], row);
 
+	MemoryCategoryScope memoryScope(MemoryCategory::Fonts);
 	auto *font = &Fonts[fontId];
 
 	if (ColorTranlations[color] != nullptr) {
@@ -183,6 +195,7 @@ Art *LoadFont(GameFontTables size, text_color color, uint16_t row)
 	if (font->surface == nullptr) {
 		LogError("Missing font: {}", path);
 	}
+	TrackExternalMemory(MemoryCategory::Fonts, FontSurfaceBytes(*font));
 
 	return font;
 }
@@ -378,6 +391,7 @@ void UnloadFonts(GameFontTables size, text_color color)
 
 	for (auto font = Fonts.begin(); font != Fonts.end();) {
 		if ((font->first & 0xFFFF0000) == fontStyle) {
+			TrackExternalMemory(MemoryCategory::Fonts, -FontSurfaceBytes(font->second));
 			font = Fonts.erase(font);
 		} else {
 			font++;
@@ -387,6 +401,8 @@ void UnloadFonts(GameFontTables size, text_color color)
 
 void UnloadFonts()
 {
+	for (auto &font : Fonts)
+		TrackExternalMemory(MemoryCategory::Fonts, -FontSurfaceBytes(font.second));
 	Fonts.clear();
 	FontKerns.clear();
 }
@@ -0,0 +1,209 @@
+#include "engine/state_hash.hpp"
+
+#include <cstring>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "items.h"
+#include "missiles.h"
+#include "monster.h"
+#include "player.h"
+
+namespace devilution {
+
+namespace {
+
+template <typename T>
+void AddValue(StateHasher &hasher, T value)
+{
+	hasher.Add(static_cast<uint32_t>(value));
+}
+
+void AddPoint(StateHasher &hasher, Point point)
+{
+	hasher.Add(point.x);
+	hasher.Add(point.y);
+}
+
+void AddDisplacement(StateHasher &hasher, Displacement displacement)
+{
+	hasher.Add(displacement.deltaX);
+	hasher.Add(displacement.deltaY);
+}
+
+void AddActorPosition(StateHasher &hasher, const ActorPosition &position)
+{
+	AddPoint(hasher, position.tile);
+	AddPoint(hasher, position.future);
+	AddPoint(hasher, position.old);
+	AddDisplacement(hasher, position.offset);
+	AddDisplacement(hasher, position.velocity);
+	AddPoint(hasher, position.temp);
+}
+
+void AddItem(StateHasher &hasher, const Item &item)
+{
+	hasher.Add(item._iSeed);
+	hasher.Add(item._iCreateInfo);
+	AddValue(hasher, item.IDidx);
+	AddPoint(hasher, item.position);
+	hasher.Add(item._iIdentified ? 1 : 0);
+	hasher.Add(item._iCharges);
+	hasher.Add(item._iDurability);
+}
+
+uint32_t HashPlayers()
+{
+	StateHasher hasher;
+	for (const Player &player : Players) {
+		if (!player.plractive)
+			continue;
+		AddValue(hasher, player._pmode);
+		hasher.AddBytes(player.walkpath, sizeof(player.walkpath));
+		AddValue(hasher, player.destAction);
+		hasher.Add(player.destParam1);
+		hasher.Add(player.destParam2);
+		hasher.Add(player.destParam3);
+		hasher.Add(player.destParam4);
+		hasher.Add(player.plrlevel);
+		AddActorPosition(hasher, player.position);
+		AddValue(hasher, player._pdir);
+		hasher.Add(player.AnimInfo.CurrentFrame);
+		hasher.Add(player._pHitPoints);
+		hasher.Add(player._pMana);
+		hasher.Add(player._pExperience);
+		hasher.Add(player._pGold);
+		hasher.Add(player._pNumInv);
+		hasher.Add(player._pLvlChanging ? 1 : 0);
+	}
+	return hasher.Finish();
+}
+
+uint32_t HashMonsters()
+{
+	StateHasher hasher;
+	hasher.Add(ActiveMonsterCount);
+	for (int i = 0; i < ActiveMonsterCount; i++) {
+		const int id = ActiveMonsters[i];
+		const Monster &monster = Monsters[id];
+		hasher.Add(id);
+		hasher.Add(monster._mFlags);
+		hasher.Add(monster._mhitpoints);
+		AddValue(hasher, monster._mmode);
+		AddValue(hasher, monster._mdir);
+		hasher.Add(monster._menemy);
+		hasher.Add(monster._mAISeed);
+		AddPoint(hasher, monster.enemyPosition);
+		AddActorPosition(hasher, monster.position);
+		hasher.Add(monster.AnimInfo.CurrentFrame);
+		AddValue(hasher, monster._mgoal);
+		hasher.Add(monster._mgoalvar1);
+		hasher.Add(monster._mgoalvar2);
+		hasher.Add(monster._mgoalvar3);
+		hasher.Add(monster._mVar1);
+		hasher.Add(monster._mVar2);
+		hasher.Add(monster._mVar3);
+		hasher.Add(monster._msquelch);
+	}
+	return hasher.Finish();
+}
+
+uint32_t HashMissiles()
+{
+	StateHasher hasher;
+	hasher.Add(ActiveMissileCount);
+	for (int i = 0; i < ActiveMissileCount; i++) {
+		const int id = ActiveMissiles[i];
+		const Missile &missile = Missiles[id];
+		hasher.Add(id);
+		AddValue(hasher, missile._mitype);
+		AddPoint(hasher, missile.position.tile);
+		AddDisplacement(hasher, missile.position.offset);
+		AddDisplacement(hasher, missile.position.velocity);
+		AddDisplacement(hasher, missile.position.traveled);
+		hasher.Add(missile._mimfnum);
+		hasher.Add(missile._miDelFlag ? 1 : 0);
+		hasher.Add(missile._mirange);
+		hasher.Add(missile._misource);
+		hasher.Add(missile._midam);
+		hasher.Add(missile.var1);
+		hasher.Add(missile.var2);
+		hasher.Add(missile.var3);
+		hasher.Add(missile.var4);
+		hasher.Add(missile.var5);
+		hasher.Add(missile.var6);
+		hasher.Add(missile.var7);
+	}
+	return hasher.Finish();
+}
+
+uint32_t HashItems()
+{
+	StateHasher hasher;
+	hasher.Add(ActiveItemCount);
+	for (int i = 0; i < ActiveItemCount; i++) {
+		const int id = ActiveItems[i];
+		hasher.Add(id);
+		AddItem(hasher, Items[id]);
+	}
+	return hasher.Finish();
+}
+
+uint32_t HashDungeon()
+{
+	StateHasher hasher;
+	hasher.AddBytes(dMonster, sizeof(dMonster));
+	hasher.AddBytes(dPlayer, sizeof(dPlayer));
+	hasher.AddBytes(dItem, sizeof(dItem));
+	return hasher.Finish();
+}
+
+} // namespace
+
+void StateHasher::AddBytes(const void *data, size_t size)
+{
+	const auto *bytes = static_cast<const uint8_t *>(data);
+	for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t), bytes += sizeof(uint32_t)) {
+		uint32_t word;
+		std::memcpy(&word, bytes, sizeof(word));
+		Add(word);
+	}
+	if (size != 0) {
+		uint32_t word = 0;
+		std::memcpy(&word, bytes, size);
+		Add(word);
+	}
+}
+
+StateHashes ComputeStateHashes()
+{
+	StateHashes hashes;
+	hashes[static_cast<size_t>(StateHashSubsystem::Rng)] = GetLCGEngineState();
+	hashes[static_cast<size_t>(StateHashSubsystem::Players)] = HashPlayers();
+	hashes[static_cast<size_t>(StateHashSubsystem::Monsters)] = HashMonsters();
+	hashes[static_cast<size_t>(StateHashSubsystem::Missiles)] = HashMissiles();
+	hashes[static_cast<size_t>(StateHashSubsystem::Items)] = HashItems();
+	hashes[static_cast<size_t>(StateHashSubsystem::Dungeon)] = HashDungeon();
+	return hashes;
+}
+
+const char *StateHashSubsystemName(StateHashSubsystem subsystem)
+{
+	switch (subsystem) {
+	case StateHashSubsystem::Rng:
+		return "Rng";
+	case StateHashSubsystem::Players:
+		return "Players";
+	case StateHashSubsystem::Monsters:
+		return "Monsters";
+	case StateHashSubsystem::Missiles:
+		return "Missiles";
+	case StateHashSubsystem::Items:
+		return "Items";
+	case StateHashSubsystem::Dungeon:
+		return "Dungeon";
+	}
+	return "Unknown";
+}
+
+} // namespace devilution
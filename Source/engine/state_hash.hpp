@@ -0,0 +1,73 @@
+/**
+ * @file state_hash.hpp
+ *
+ * Checksums of the simulation state, used to verify that demos replay identically.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/enum_traits.h"
+
+namespace devilution {
+
+enum class StateHashSubsystem : uint8_t {
+	FIRST,
+	Rng = FIRST,
+	Players,
+	Monsters,
+	Missiles,
+	Items,
+	Dungeon,
+
+	LAST = Dungeon
+};
+
+using StateHashes = std::array<uint32_t, enum_size<StateHashSubsystem>::value>;
+
+/**
+ * @brief Fast non-cryptographic hash fed one 32 bit word at a time
+ */
+class StateHasher {
+public:
+	void Add(uint32_t value)
+	{
+		value *= 0xCC9E2D51;
+		value = (value << 15) | (value >> 17);
+		value *= 0x1B873593;
+		hash_ ^= value;
+		hash_ = (hash_ << 13) | (hash_ >> 19);
+		hash_ = hash_ * 5 + 0xE6546B64;
+		length_++;
+	}
+
+	void AddBytes(const void *data, size_t size);
+
+	uint32_t Finish() const
+	{
+		uint32_t hash = hash_ ^ length_;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6B;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+private:
+	uint32_t hash_ = 0;
+	uint32_t length_ = 0;
+};
+
+/**
+ * @brief Hash the state that the game logic changes each tick, one hash per subsystem
+ *
+ * Only fields that are deterministic are included, so pointers, graphics and padding are left out.
+ */
+StateHashes ComputeStateHashes();
+
+const char *StateHashSubsystemName(StateHashSubsystem subsystem);
+
+} // namespace devilution
@@ -0,0 +1,240 @@
+#include "engine/tick_stats.hpp"
+
+#ifdef TICK_STATS
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+
+#include <fmt/format.h>
+
+#include "diablo.h"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/profiler.hpp"
+
+namespace devilution {
+
+namespace tick_stats {
+
+namespace {
+
+/** Bucket i counts the durations below 2^(i+1) microseconds, the last one everything above */
+constexpr size_t NumBuckets = 24;
+constexpr uint64_t ExportIntervalNs = 10000000000;
+
+struct Histogram {
+	uint64_t samples;
+	uint64_t totalNs;
+	uint64_t maxNs;
+	std::array<uint64_t, NumBuckets> buckets;
+
+	void Add(uint64_t ns)
+	{
+		samples++;
+		totalNs += ns;
+		maxNs = std::max(maxNs, ns);
+		size_t bucket = 0;
+		for (uint64_t us = ns / 1000; us >= 2 && bucket < NumBuckets - 1; us >>= 1)
+			bucket++;
+		buckets[bucket]++;
+	}
+
+	/** Upper bound of the bucket containing the percentile, so it is never reported too low */
+	uint64_t PercentileUs(unsigned percent) const
+	{
+		const uint64_t target = (samples * percent + 99) / 100;
+		uint64_t seen = 0;
+		for (size_t i = 0; i < NumBuckets; i++) {
+			seen += buckets[i];
+			if (seen >= target && seen > 0)
+				return std::min<uint64_t>(uint64_t { 2 } << i, maxNs / 1000);
+		}
+		return maxNs / 1000;
+	}
+};
+
+bool Enabled = false;
+std::string ExportPath;
+uint32_t SampleInterval;
+uint64_t StartNs;
+uint64_t LastExportNs;
+
+uint64_t Ticks;
+uint64_t SampledTicks;
+uint64_t OverBudgetTicks;
+std::array<uint64_t, NumGameLogicSteps> StepRuns;
+Histogram TickHistogram;
+std::array<Histogram, NumGameLogicSteps> StepHistograms;
+/** How often each step took the most time of a sampled tick that exceeded gnTickDelay */
+std::array<uint64_t, NumGameLogicSteps> OverBudgetCulprits;
+
+/** Whether the current tick is timed */
+bool Sampling;
+uint32_t TicksUntilSample;
+GameLogicStep CurrentStep;
+uint64_t TickStartNs;
+uint64_t StepStartNs;
+std::array<uint64_t, NumGameLogicSteps> CurrentTickSteps;
+std::array<bool, NumGameLogicSteps> CurrentTickRan;
+
+void WriteHistogram(std::ofstream &out, const Histogram &histogram)
+{
+	const double meanUs = histogram.samples != 0 ? histogram.totalNs / 1000.0 / histogram.samples : 0;
+	out << fmt::format(R"("samples": {}, "meanUs": {:.1f}, "p50Us": {}, "p90Us": {}, "p99Us": {}, "maxUs": {}, "buckets": [)",
+	    histogram.samples, meanUs, histogram.PercentileUs(50), histogram.PercentileUs(90), histogram.PercentileUs(99), histogram.maxNs / 1000);
+	for (size_t i = 0; i < NumBuckets; i++)
+		out << (i == 0 ? "" : ", ") << histogram.buckets[i];
+	out << ']';
+}
+
+void Export(uint64_t now)
+{
+	LastExportNs = now;
+
+	const std::string tempPath = ExportPath + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::trunc);
+		if (!out) {
+			LogError("Failed to write tick statistics to {}", tempPath);
+			return;
+		}
+		out << "{\n";
+		out << fmt::format(R"(  "uptimeSeconds": {:.1f},)", (now - StartNs) / 1e9) << '\n';
+		out << fmt::format(R"(  "tickDelayMs": {},)", gnTickDelay) << '\n';
+		out << fmt::format(R"(  "sampleInterval": {},)", SampleInterval) << '\n';
+		out << fmt::format(R"(  "ticks": {},)", Ticks) << '\n';
+		out << fmt::format(R"(  "sampledTicks": {},)", SampledTicks) << '\n';
+		out << fmt::format(R"(  "overBudgetTicks": {},)", OverBudgetTicks) << '\n';
+		out << R"(  "tick": { )";
+		WriteHistogram(out, TickHistogram);
+		out << " },\n";
+		out << R"(  "steps": [)" << '\n';
+		for (size_t i = 0; i < NumGameLogicSteps; i++) {
+			out << fmt::format(R"(    {{ "name": "{}", "runs": {}, "overBudgetCulprit": {}, )",
+			    GameLogicStepName(static_cast<GameLogicStep>(i)), StepRuns[i], OverBudgetCulprits[i]);
+			WriteHistogram(out, StepHistograms[i]);
+			out << (i + 1 < NumGameLogicSteps ? " },\n" : " }\n");
+		}
+		out << "  ]\n}\n";
+	}
+
+	// Replace the previous file in one step, so a collector never reads a partial file
+	if (std::rename(tempPath.c_str(), ExportPath.c_str()) != 0) {
+		RemoveFile(ExportPath.c_str());
+		if (std::rename(tempPath.c_str(), ExportPath.c_str()) != 0)
+			LogError("Failed to write tick statistics to {}", ExportPath);
+	}
+}
+
+} // namespace
+
+void Init(std::string path, uint32_t sampleInterval)
+{
+	ExportPath = std::move(path);
+	SampleInterval = std::max<uint32_t>(sampleInterval, 1);
+	StartNs = profiler::NowNs();
+	LastExportNs = StartNs;
+
+	Ticks = 0;
+	SampledTicks = 0;
+	OverBudgetTicks = 0;
+	StepRuns.fill(0);
+	TickHistogram = {};
+	StepHistograms.fill({});
+	OverBudgetCulprits.fill(0);
+	Sampling = false;
+	TicksUntilSample = 0;
+	CurrentStep = GameLogicStep::None;
+
+	Enabled = true;
+}
+
+void Shutdown()
+{
+	if (!Enabled)
+		return;
+	Export(profiler::NowNs());
+	Enabled = false;
+}
+
+bool IsEnabled()
+{
+	return Enabled;
+}
+
+void TickStart()
+{
+	if (!Enabled)
+		return;
+
+	Ticks++;
+	StepRuns[static_cast<size_t>(GameLogicStep::None)]++;
+	CurrentStep = GameLogicStep::None;
+	Sampling = TicksUntilSample == 0;
+	if (!Sampling) {
+		TicksUntilSample--;
+		return;
+	}
+	TicksUntilSample = SampleInterval - 1;
+
+	CurrentTickSteps.fill(0);
+	CurrentTickRan.fill(false);
+	TickStartNs = profiler::NowNs();
+	StepStartNs = TickStartNs;
+}
+
+void EnterStep(GameLogicStep step)
+{
+	if (!Enabled)
+		return;
+
+	if (step != GameLogicStep::None)
+		StepRuns[static_cast<size_t>(step)]++;
+	if (!Sampling) {
+		CurrentStep = step;
+		return;
+	}
+
+	const uint64_t now = profiler::NowNs();
+	const auto current = static_cast<size_t>(CurrentStep);
+	CurrentTickSteps[current] += now - StepStartNs;
+	CurrentTickRan[current] = true;
+	CurrentStep = step;
+	StepStartNs = now;
+}
+
+void TickEnd()
+{
+	if (!Enabled || !Sampling)
+		return;
+
+	EnterStep(GameLogicStep::None);
+	Sampling = false;
+
+	const uint64_t tickNs = StepStartNs - TickStartNs;
+	SampledTicks++;
+	TickHistogram.Add(tickNs);
+	size_t slowestStep = 0;
+	for (size_t i = 0; i < NumGameLogicSteps; i++) {
+		if (!CurrentTickRan[i])
+			continue;
+		StepHistograms[i].Add(CurrentTickSteps[i]);
+		if (CurrentTickSteps[i] > CurrentTickSteps[slowestStep])
+			slowestStep = i;
+	}
+	if (tickNs > gnTickDelay * uint64_t { 1000000 }) {
+		OverBudgetTicks++;
+		OverBudgetCulprits[slowestStep]++;
+	}
+
+	if (StepStartNs - LastExportNs >= ExportIntervalNs)
+		Export(StepStartNs);
+}
+
+} // namespace tick_stats
+
+} // namespace devilution
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file tick_stats.hpp
+ *
+ * Counters and sampled timers of the game logic steps, enabled with the TICK_STATS build option.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace devilution {
+
+enum class GameLogicStep;
+
+namespace tick_stats {
+
+/** Time one in this many game ticks by default */
+constexpr uint32_t DefaultSampleInterval = 8;
+
+#ifdef TICK_STATS
+/**
+ * @brief Start counting game ticks and periodically write the statistics to the given path
+ *
+ * The file is replaced atomically, so a collector can read it at any time.
+ * @param sampleInterval Time one in this many ticks, the others are only counted
+ */
+void Init(std::string path, uint32_t sampleInterval = DefaultSampleInterval);
+/**
+ * @brief Write the final statistics
+ */
+void Shutdown();
+bool IsEnabled();
+
+void TickStart();
+/**
+ * @brief Called by SetGameLogicStep, ends the current step of the tick and starts the given one
+ */
+void EnterStep(GameLogicStep step);
+/**
+ * @brief Ends the tick and writes the statistics if the export interval has passed
+ */
+void TickEnd();
+#else
+inline void Init(std::string /*path*/, uint32_t /*sampleInterval*/ = DefaultSampleInterval)
+{
+}
+inline void Shutdown()
+{
+}
+inline bool IsEnabled()
+{
+	return false;
+}
+inline void TickStart()
+{
+}
+inline void EnterStep(GameLogicStep /*step*/)
+{
+}
+inline void TickEnd()
+{
+}
+#endif
+
+} // namespace tick_stats
+
+} // namespace devilution
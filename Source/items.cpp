@@ -35,6 +35,8 @@
 #include "town.h"
 #include "utils/language.h"
 #include "utils/math.h"
+#include "utils/memory_stats.hpp"
+#include "utils/profiler.hpp"
 #include "utils/stdcompat/algorithm.hpp"
 #include "utils/utf8.hpp"
 
@@ -2485,6 +2487,7 @@ bool IsUniqueAvailable(int i)
 
 void InitItemGFX()
 {
+	MemoryCategoryScope memoryScope(MemoryCategory::Items);
 	char arglist[64];
 
 	int itemTypes = gbIsHellfire ? ITEMTYPES : 35;
@@ -3602,6 +3605,7 @@ void DeleteItem(int i)
 
 void ProcessItems()
 {
+	DVL_PROFILE_ZONE("ProcessItems");
 	for (int i = 0; i < ActiveItemCount; i++) {
 		int ii = ActiveItems[i];
 		auto &item = Items[ii];
@@ -11,6 +11,7 @@
 #include "diablo.h"
 #include "engine/load_file.hpp"
 #include "player.h"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 
@@ -1042,6 +1043,7 @@ void ChangeLight(int i, Point position, int r)
 
 void ProcessLightList()
 {
+	DVL_PROFILE_ZONE("ProcessLightList");
 	if (DisableLighting) {
 		return;
 	}
@@ -1147,6 +1149,7 @@ void ChangeVisionXY(int id, Point position)
 
 void ProcessVisionList()
 {
+	DVL_PROFILE_ZONE("ProcessVisionList");
 	if (!dovision)
 		return;
 
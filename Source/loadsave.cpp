@@ -5,9 +5,11 @@
  */
 #include "loadsave.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstring>
 #include <numeric>
+#include <type_traits>
 #include <unordered_map>
 
 #include <SDL.h>
@@ -38,6 +40,10 @@ uint8_t giNumberOfLevels;
 
 namespace {
 
+/** Vanilla saves store missile indices as bytes, larger pools (-DMAXMISSILES) need 16 bits */
+using MissileIndex = std::conditional_t<(MAXMISSILES <= INT8_MAX), int8_t, int16_t>;
+static_assert(MAXMISSILES <= INT16_MAX, "Missile indices are saved as 16 bit values");
+
 uint8_t giNumberQuests;
 uint8_t giNumberOfSmithPremiumItems;
 
@@ -1530,6 +1536,25 @@ void SaveDroppedItemLocations(SaveHelper &file, const std::unordered_map<uint8_t
 
 const int DiabloItemSaveSize = 368;
 const int HellfireItemSaveSize = 372;
+/** Bytes used by SaveMissile and the two pool indices of a missile */
+const int MissileSaveSize = 176 + 2 * sizeof(MissileIndex);
+/** Size of the game save without the missile pool, the vanilla buffer of 320 KiB fits 125 missiles */
+const int GameSaveBaseSize = 320 * 1024 - 125 * (176 + 2 * sizeof(int8_t));
+
+/**
+ * @brief Returns the magic number that starts the game saves of this build
+ *
+ * Builds with a non-default missile pool (-DMAXMISSILES) save a different layout, so they lowercase
+ * the last letter of the magic number. Other builds reject their saves as invalid and vice versa.
+ */
+uint32_t GameSaveMagic(const char *magic)
+{
+	uint32_t magicNumber = LoadLE32(magic);
+#if MAXMISSILES != 125
+	magicNumber ^= 0x20U << 24;
+#endif
+	return magicNumber;
+}
 
 } // namespace
 
@@ -1659,17 +1684,17 @@ _item_indexes RemapItemIdxToSpawn(_item_indexes i)
 bool IsHeaderValid(uint32_t magicNumber)
 {
 	gbIsHellfireSaveGame = false;
-	if (magicNumber == LoadLE32("SHAR")) {
+	if (magicNumber == GameSaveMagic("SHAR")) {
 		return true;
 	}
-	if (magicNumber == LoadLE32("SHLF")) {
+	if (magicNumber == GameSaveMagic("SHLF")) {
 		gbIsHellfireSaveGame = true;
 		return true;
 	}
-	if (!gbIsSpawn && magicNumber == LoadLE32("RETL")) {
+	if (!gbIsSpawn && magicNumber == GameSaveMagic("RETL")) {
 		return true;
 	}
-	if (!gbIsSpawn && magicNumber == LoadLE32("HELF")) {
+	if (!gbIsSpawn && magicNumber == GameSaveMagic("HELF")) {
 		gbIsHellfireSaveGame = true;
 		return true;
 	}
@@ -1749,6 +1774,11 @@ void LoadGame(bool firstflag)
 
 	if (!IsHeaderValid(file.NextLE<uint32_t>()))
 		app_fatal("%s", _("Invalid save file"));
+#if MAXMISSILES != 125
+	// Saves of builds with another non-default pool size have the same magic number
+	if (file.NextLE<uint16_t>() != MAXMISSILES)
+		app_fatal("%s", _("Invalid save file"));
+#endif
 
 	if (gbIsHellfireSaveGame) {
 		giNumberOfLevels = 25;
@@ -1824,11 +1854,16 @@ void LoadGame(bool firstflag)
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			SyncPackSize(Monsters[ActiveMonsters[i]]);
 		for (int &missileId : ActiveMissiles)
-			missileId = file.NextLE<int8_t>();
+			missileId = file.NextLE<MissileIndex>();
 		for (int &missileId : AvailableMissiles)
-			missileId = file.NextLE<int8_t>();
-		for (int i = 0; i < ActiveMissileCount; i++)
+			missileId = file.NextLE<MissileIndex>();
+		if (ActiveMissileCount < 0 || ActiveMissileCount > MAXMISSILES)
+			app_fatal("%s", _("Invalid save file"));
+		for (int i = 0; i < ActiveMissileCount; i++) {
+			if (ActiveMissiles[i] < 0 || ActiveMissiles[i] >= MAXMISSILES)
+				app_fatal("%s", _("Invalid save file"));
 			LoadMissile(&file, Missiles[ActiveMissiles[i]]);
+		}
 		for (int &objectId : ActiveObjects)
 			objectId = file.NextLE<int8_t>();
 		for (int &objectId : AvailableObjects)
@@ -1957,18 +1992,21 @@ void SaveHeroItems(Player &player)
 
 void SaveGameData()
 {
-	SaveHelper file("game", 320 * 1024);
+	SaveHelper file("game", GameSaveBaseSize + MAXMISSILES * MissileSaveSize + sizeof(uint16_t));
 
 	if (gbIsSpawn && !gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("SHAR"));
+		file.WriteLE<uint32_t>(GameSaveMagic("SHAR"));
 	else if (gbIsSpawn && gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("SHLF"));
+		file.WriteLE<uint32_t>(GameSaveMagic("SHLF"));
 	else if (!gbIsSpawn && gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("HELF"));
+		file.WriteLE<uint32_t>(GameSaveMagic("HELF"));
 	else if (!gbIsSpawn && !gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("RETL"));
+		file.WriteLE<uint32_t>(GameSaveMagic("RETL"));
 	else
 		app_fatal("%s", _("Invalid game state"));
+#if MAXMISSILES != 125
+	file.WriteLE<uint16_t>(MAXMISSILES);
+#endif
 
 	if (gbIsHellfire) {
 		giNumberOfLevels = 25;
@@ -2015,9 +2053,9 @@ void SaveGameData()
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			SaveMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (int missileId : ActiveMissiles)
-			file.WriteLE<int8_t>(missileId);
+			file.WriteLE<MissileIndex>(missileId);
 		for (int missileId : AvailableMissiles)
-			file.WriteLE<int8_t>(missileId);
+			file.WriteLE<MissileIndex>(missileId);
 		for (int i = 0; i < ActiveMissileCount; i++)
 			SaveMissile(&file, Missiles[ActiveMissiles[i]]);
 		for (int objectId : ActiveObjects)
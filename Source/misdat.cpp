@@ -8,6 +8,7 @@
 #include "engine/cel_header.hpp"
 #include "engine/load_file.hpp"
 #include "missiles.h"
+#include "utils/memory_stats.hpp"
 
 namespace devilution {
 
@@ -250,6 +251,7 @@ void MissileFileData::LoadGFX()
 
 void InitMissileGFX(bool loadHellfireGraphics)
 {
+	MemoryCategoryScope memoryScope(MemoryCategory::Missiles);
 	for (size_t mi = 0; MissileSpriteData[mi].animFAmt != 0; mi++) {
 		if (!loadHellfireGraphics && mi > MFILE_SCBSEXPD)
 			break;
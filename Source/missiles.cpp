@@ -5,7 +5,9 @@
  */
 #include "missiles.h"
 
+#include <array>
 #include <climits>
+#include <vector>
 
 #include "control.h"
 #include "controls/plrctrls.h"
@@ -23,6 +25,7 @@
 #include "monster.h"
 #include "spells.h"
 #include "trigs.h"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 
@@ -82,18 +85,48 @@ bool CheckBlock(Point from, Point to)
 	return false;
 }
 
+constexpr int MaxClosestSearchRadius = 19;
+
+/**
+ * @brief Tile offsets in the order FindClosestValidPosition visits them, grouped by radius
+ *
+ * The offsets are recorded once by running the search with a predicate that never matches, so FindClosest
+ * keeps the exact same target preference while scanning a flat array instead of calling through std::function.
+ */
+struct ClosestSearchOrder {
+	std::vector<Displacement> offsets;
+	/** Index in to offsets one past the last tile of the given radius */
+	std::array<size_t, MaxClosestSearchRadius + 1> radiusEnd;
+
+	ClosestSearchOrder()
+	{
+		radiusEnd[0] = 0;
+		for (unsigned radius = 1; radius <= MaxClosestSearchRadius; radius++) {
+			FindClosestValidPosition(
+			    [this](Point target) {
+				    offsets.push_back(target - Point { 0, 0 });
+				    return false;
+			    },
+			    { 0, 0 }, radius, radius);
+			radiusEnd[radius] = offsets.size();
+		}
+	}
+};
+
 Monster *FindClosest(Point source, int rad)
 {
-	std::optional<Point> monsterPosition = FindClosestValidPosition(
-	    [&source](Point target) {
-		    // search for a monster with clear line of sight
-		    return InDungeonBounds(target) && dMonster[target.x][target.y] > 0 && !CheckBlock(source, target);
-	    },
-	    source, 1, rad);
+	static const ClosestSearchOrder SearchOrder;
 
-	if (monsterPosition) {
-		int mid = dMonster[monsterPosition->x][monsterPosition->y];
-		return &Monsters[mid - 1];
+	assert(rad >= 1 && rad <= MaxClosestSearchRadius);
+	const size_t end = SearchOrder.radiusEnd[rad];
+	for (size_t i = 0; i < end; i++) {
+		Point target = source + SearchOrder.offsets[i];
+		if (!InDungeonBounds(target))
+			continue;
+		int mid = dMonster[target.x][target.y];
+		// search for a monster with clear line of sight
+		if (mid > 0 && !CheckBlock(source, target))
+			return &Monsters[mid - 1];
 	}
 
 	return nullptr;
@@ -4207,6 +4240,7 @@ void ProcessManaShield()
 
 void ProcessMissiles()
 {
+	DVL_PROFILE_ZONE("ProcessMissiles");
 	for (int i = 0; i < ActiveMissileCount; i++) {
 		auto &missile = Missiles[ActiveMissiles[i]];
 		const auto &position = missile.position.tile;
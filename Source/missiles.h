@@ -16,7 +16,16 @@
 
 namespace devilution {
 
+/**
+ * @brief Size of the missile pool
+ *
+ * Can be raised at build time (-DMAXMISSILES=<n>) for single player and modded games that hit the cap during large fights.
+ * The pool size is part of the save game layout and of the simulation, so saves and multiplayer games are only
+ * compatible between builds using the same value. Vanilla uses 125.
+ */
+#ifndef MAXMISSILES
 #define MAXMISSILES 125
+#endif
 
 constexpr Point GolemHoldingCell = Point { 1, 0 };
 
@@ -32,6 +32,8 @@
 #include "towners.h"
 #include "trigs.h"
 #include "utils/language.h"
+#include "utils/memory_stats.hpp"
+#include "utils/profiler.hpp"
 #include "utils/utf8.hpp"
 
 #ifdef _DEBUG
@@ -839,9 +841,16 @@ void UpdateEnemy(Monster &monster)
 			}
 		}
 	}
+	// These only depend on the searching monster, so evaluate them once instead of for every candidate
+	const bool isGolem = (monster._mFlags & MFLAG_GOLEM) != 0;
+	const bool isBerserk = (monster._mFlags & MFLAG_BERSERK) != 0;
+	const bool isRanged = IsRanged(monster);
 	for (int j = 0; j < ActiveMonsterCount; j++) {
 		int mi = ActiveMonsters[j];
 		auto &otherMonster = Monsters[mi];
+		// Regular monsters only ever target golems, reject everything else before looking at any other state
+		if (!isGolem && !isBerserk && (otherMonster._mFlags & MFLAG_GOLEM) == 0)
+			continue;
 		if (&otherMonster == &monster)
 			continue;
 		if ((otherMonster._mhitpoints >> 6) <= 0)
@@ -850,20 +859,13 @@ void UpdateEnemy(Monster &monster)
 			continue;
 		if (M_Talker(otherMonster) && otherMonster.mtalkmsg != TEXT_NONE)
 			continue;
-		bool isBerserked = (monster._mFlags & MFLAG_BERSERK) != 0 || (otherMonster._mFlags & MFLAG_BERSERK) != 0;
-		if ((monster._mFlags & MFLAG_GOLEM) != 0 && (otherMonster._mFlags & MFLAG_GOLEM) != 0 && !isBerserked) // prevent golems from fighting each other
+		bool isBerserked = isBerserk || (otherMonster._mFlags & MFLAG_BERSERK) != 0;
+		if (isGolem && (otherMonster._mFlags & MFLAG_GOLEM) != 0 && !isBerserked) // prevent golems from fighting each other
 			continue;
 
 		int dist = otherMonster.position.tile.WalkingDistance(position);
-		if (((monster._mFlags & MFLAG_GOLEM) == 0
-		        && (monster._mFlags & MFLAG_BERSERK) == 0
-		        && dist >= 2
-		        && !IsRanged(monster))
-		    || ((monster._mFlags & MFLAG_GOLEM) == 0
-		        && (monster._mFlags & MFLAG_BERSERK) == 0
-		        && (otherMonster._mFlags & MFLAG_GOLEM) == 0)) {
+		if (!isGolem && !isBerserk && dist >= 2 && !isRanged)
 			continue;
-		}
 		bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
 		if ((sameroom && !bestsameroom)
 		    || ((sameroom || !bestsameroom) && dist < bestDist)
@@ -2002,7 +2004,7 @@ bool IsTileSafe(const Monster &monster, Point position)
 	bool fearsLightning = (monster.mMagicRes & IMMUNE_LIGHTNING) == 0 || monster.MType->mtype == MT_DIABLO;
 
 	for (int j = 0; j < ActiveMissileCount; j++) {
-		uint8_t mi = ActiveMissiles[j];
+		int mi = ActiveMissiles[j];
 		auto &missile = Missiles[mi];
 		if (missile.position.tile == position) {
 			if (fearsFire && missile._mitype == MIS_FIREWALL) {
@@ -3693,6 +3695,7 @@ void GetLevelMTypes()
 
 void InitMonsterGFX(int monst)
 {
+	MemoryCategoryScope memoryScope(MemoryCategory::Monsters);
 	int mtype = LevelMonsterTypes[monst].mtype;
 	int width = MonstersData[mtype].width;
 
@@ -4268,6 +4271,7 @@ void DeleteMonsterList()
 
 void ProcessMonsters()
 {
+	DVL_PROFILE_ZONE("ProcessMonsters");
 	DeleteMonsterList();
 
 	assert(ActiveMonsterCount >= 0 && ActiveMonsterCount <= MAXMONSTERS);
@@ -164,44 +164,60 @@ struct CMonster {
 	const MonsterData *MData;
 };
 
-struct Monster { // note: missing field _mAFNum
-	int _mMTidx;
+/**
+ * @brief Runtime state of a monster instance
+ *
+ * The members are split into a hot block that ProcessMonsters and the target search in UpdateEnemy
+ * read for every active monster each game tick, followed by the remaining (cold) state. The hot block
+ * is ordered so that the fields checked by the UpdateEnemy scan (_mFlags, _mhitpoints, _mAi,
+ * position.tile and position.future) fall within the first cache line of each aligned entry.
+ * Keep new per-tick fields in the hot block and everything else below it.
+ *
+ * The layout is not part of any serialization format, loadsave.cpp and sync.cpp read and write
+ * the members individually.
+ */
+struct alignas(64) Monster { // note: missing field _mAFNum
+	uint32_t _mFlags;
+	int _mhitpoints;
+	int _mmaxhp;
 	MonsterMode _mmode;
-	monster_goal _mgoal;
-	int _mgoalvar1;
-	int _mgoalvar2;
-	int _mgoalvar3;
-	uint8_t _pathcount;
-	ActorPosition position;
+	_mai_id _mAi;
+	uint8_t _msquelch;
+	int8_t mLevel;
 	/** Direction faced by monster (direction enum) */
 	Direction _mdir;
+	uint8_t leader;
+	LeaderRelation leaderRelation;
 	/** The current target of the mosnter. An index in to either the plr or monster array based on the _meflag value. */
 	int _menemy;
+	/** Seed used to determine AI behaviour/sync sounds in multiplayer games? */
+	uint32_t _mAISeed;
+	CMonster *MType;
 	/** Usually correspond's to the enemy's future position */
 	Point enemyPosition;
+	ActorPosition position;
 	/**
 	 * @brief Contains Information for current Animation
 	 */
 	AnimationInfo AnimInfo;
+
+	int _mMTidx;
+	monster_goal _mgoal;
+	int _mgoalvar1;
+	int _mgoalvar2;
+	int _mgoalvar3;
+	uint8_t _pathcount;
 	bool _mDelFlag;
 	int _mVar1;
 	int _mVar2;
 	int _mVar3;
-	int _mmaxhp;
-	int _mhitpoints;
-	_mai_id _mAi;
 	uint8_t _mint;
-	uint32_t _mFlags;
-	uint8_t _msquelch;
 	/** Seed used to determine item drops on death */
 	uint32_t _mRndSeed;
-	/** Seed used to determine AI behaviour/sync sounds in multiplayer games? */
-	uint32_t _mAISeed;
 	uint8_t _uniqtype;
 	uint8_t _uniqtrans;
 	int8_t _udeadval;
 	int8_t mWhoHit;
-	int8_t mLevel;
 	uint16_t mExp;
 	uint16_t mHit;
 	uint8_t mMinDamage;
@@ -212,12 +228,9 @@ struct Monster { // note: missing field _mAFNum
 	uint8_t mArmorClass;
 	uint16_t mMagicRes;
 	_speech_id mtalkmsg;
-	uint8_t leader;
-	LeaderRelation leaderRelation;
 	uint8_t packsize;
 	int8_t mlid; // BUGFIX -1 is used when not emitting light this should be signed (fixed)
 	const char *mName;
-	CMonster *MType;
 	const MonsterData *MData;
 
 	/**
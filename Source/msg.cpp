@@ -3,6 +3,7 @@
  *
  * Implementation of function for sending and reciving network messages.
  */
+#include <algorithm>
 #include <climits>
 #include <memory>
 
@@ -33,6 +34,8 @@
 #include "towners.h"
 #include "trigs.h"
 #include "utils/language.h"
+#include "utils/log.hpp"
+#include "utils/memory_stats.hpp"
 
 namespace devilution {
 
@@ -52,6 +55,16 @@ struct TMegaPkt {
 	}
 };
 
+/**
+ * @brief Compressed export of a level delta, reused while the level stays unchanged
+ */
+struct DeltaLevelCache {
+	/** Set by DeltaLevelChanged, data is stale until the level is exported again */
+	bool dirty = true;
+	std::unique_ptr<byte[]> data;
+	uint32_t size = 0;
+};
+
 #define MAX_CHUNKS (NUMLEVELS + 4)
 
 uint32_t sgdwOwnerWait;
@@ -62,11 +75,21 @@ BYTE sbLastCmd;
 byte sgRecvBuf[sizeof(DLevel) + 1];
 _cmd_id sgbRecvCmd;
 LocalLevel sgLocals[NUMLEVELS];
+DeltaLevelCache sgLevelCache[NUMLEVELS];
 DJunk sgJunk;
 bool sgbDeltaChanged;
 BYTE sgbDeltaChunks;
 std::list<TMegaPkt> MegaPktList;
 
+/**
+ * @brief Marks a level delta as changed, call it whenever sgLevels is written
+ */
+void DeltaLevelChanged(uint8_t level)
+{
+	sgbDeltaChanged = true;
+	sgLevelCache[level].dirty = true;
+}
+
 void GetNextPacket()
 {
 	MegaPktList.emplace_back();
@@ -299,20 +322,66 @@ void DeltaImportJunk(const byte *src)
 	}
 }
 
+/**
+ * @brief Codec for level deltas sent to joining players, as announced in the GameData of the game creator
+ *
+ * Games created by builds that don't announce a codec get PKWARE, which every build can decode.
+ */
+CompressionCodec GetDeltaCodec()
+{
+	if (sgGameInitInfo.deltaCodec == static_cast<uint8_t>(CompressionCodec::Zlib))
+		return CompressionCodec::Zlib;
+	return CompressionCodec::Pkware;
+}
+
 DWORD CompressData(byte *buffer, byte *end)
 {
+	const CompressionCodec codec = GetDeltaCodec();
 	DWORD size = end - buffer - 1;
-	DWORD pkSize = PkwareCompress(buffer + 1, size);
+	DWORD pkSize = CompressBuffer(codec, buffer + 1, size);
 
-	*buffer = size != pkSize ? byte { 1 } : byte { 0 };
+	*buffer = static_cast<byte>(size != pkSize ? codec : CompressionCodec::None);
 
 	return pkSize + 1;
 }
 
+/**
+ * @brief Checks if the level delta still has the state set by delta_init
+ */
+bool IsDeltaLevelPristine(const DLevel &level)
+{
+	const auto *data = reinterpret_cast<const byte *>(&level);
+	return std::all_of(data, data + sizeof(level), [](byte b) { return b == byte { 0xFF }; });
+}
+
+void DeltaExportLevel(int pnum, uint8_t i)
+{
+	MemoryCategoryScope memoryScope(MemoryCategory::Levels);
+	DeltaLevelCache &cache = sgLevelCache[i];
+	if (cache.dirty) {
+		std::unique_ptr<byte[]> dst { new byte[sizeof(DLevel) + 1] };
+		byte *dstEnd = &dst.get()[1];
+		dstEnd = DeltaExportItem(dstEnd, sgLevels[i].item);
+		dstEnd = DeltaExportObject(dstEnd, sgLevels[i].object);
+		dstEnd = DeltaExportMonster(dstEnd, sgLevels[i].monster);
+		cache.size = CompressData(dst.get(), dstEnd);
+		cache.data = std::move(dst);
+		cache.dirty = false;
+	}
+
+	std::unique_ptr<byte[]> dst { new byte[cache.size] };
+	memcpy(dst.get(), cache.data.get(), cache.size);
+	dthread_send_delta(pnum, static_cast<_cmd_id>(i + CMD_DLEVEL_0), std::move(dst), cache.size);
+}
+
 void DeltaImportData(_cmd_id cmd, DWORD recvOffset)
 {
-	if (sgRecvBuf[0] != byte { 0 })
-		PkwareDecompress(&sgRecvBuf[1], recvOffset, sizeof(sgRecvBuf) - 1);
+	auto codec = static_cast<CompressionCodec>(sgRecvBuf[0]);
+	if (!DecompressBuffer(codec, &sgRecvBuf[1], recvOffset, sizeof(sgRecvBuf) - 1)) {
+		LogError("Dropped level delta {} with codec {}, it could not be decoded", static_cast<int>(cmd), static_cast<int>(codec));
+		sgbDeltaChunks++;
+		return;
+	}
 
 	byte *src = &sgRecvBuf[1];
 	if (cmd == CMD_DLEVEL_JUNK) {
@@ -322,6 +391,7 @@ void DeltaImportData(_cmd_id cmd, DWORD recvOffset)
 		src += DeltaImportItem(src, sgLevels[i].item);
 		src += DeltaImportObject(src, sgLevels[i].object);
 		DeltaImportMonster(src, sgLevels[i].monster);
+		DeltaLevelChanged(i);
 	} else {
 		app_fatal("Unkown network message type: %i", cmd);
 	}
@@ -376,7 +446,7 @@ void DeltaSyncGolem(const TCmdGolem &message, int pnum, uint8_t level)
 	if (!gbIsMultiplayer)
 		return;
 
-	sgbDeltaChanged = true;
+	DeltaLevelChanged(level);
 	DMonsterStr &monster = sgLevels[level].monster[pnum];
 	monster._mx = message._mx;
 	monster._my = message._my;
@@ -400,7 +470,7 @@ void DeltaLeaveSync(BYTE bLevel)
 		auto &monster = Monsters[ma];
 		if (monster._mhitpoints == 0)
 			continue;
-		sgbDeltaChanged = true;
+		DeltaLevelChanged(bLevel);
 		DMonsterStr &delta = sgLevels[bLevel].monster[ma];
 		delta._mx = monster.position.tile.x;
 		delta._my = monster.position.tile.y;
@@ -418,7 +488,7 @@ void DeltaSyncObject(int oi, _cmd_id bCmd, BYTE bLevel)
 	if (!gbIsMultiplayer)
 		return;
 
-	sgbDeltaChanged = true;
+	DeltaLevelChanged(bLevel);
 	sgLevels[bLevel].object[oi].bCmd = bCmd;
 }
 
@@ -435,12 +505,12 @@ bool DeltaGetItem(const TCmdGItem &message, BYTE bLevel)
 			return true;
 		}
 		if (item.bCmd == CMD_STAND) {
-			sgbDeltaChanged = true;
+			DeltaLevelChanged(bLevel);
 			item.bCmd = CMD_WALKXY;
 			return true;
 		}
 		if (item.bCmd == CMD_ACK_PLRINFO) {
-			sgbDeltaChanged = true;
+			DeltaLevelChanged(bLevel);
 			item.bCmd = CMD_INVALID;
 			return true;
 		}
@@ -453,7 +523,7 @@ bool DeltaGetItem(const TCmdGItem &message, BYTE bLevel)
 
 	for (TCmdPItem &item : sgLevels[bLevel].item) {
 		if (item.bCmd == CMD_INVALID) {
-			sgbDeltaChanged = true;
+			DeltaLevelChanged(bLevel);
 			item.bCmd = CMD_WALKXY;
 			item.x = message.x;
 			item.y = message.y;
@@ -498,7 +568,7 @@ void DeltaPutItem(const TCmdPItem &message, Point position, BYTE bLevel)
 
 	for (TCmdPItem &item : sgLevels[bLevel].item) {
 		if (item.bCmd == CMD_INVALID) {
-			sgbDeltaChanged = true;
+			DeltaLevelChanged(bLevel);
 			memcpy(&item, &message, sizeof(TCmdPItem));
 			item.bCmd = CMD_ACK_PLRINFO;
 			item.x = position.x;
@@ -2010,13 +2080,11 @@ void DeltaExportData(int pnum)
 {
 	if (sgbDeltaChanged) {
 		for (int i = 0; i < NUMLEVELS; i++) {
-			std::unique_ptr<byte[]> dst { new byte[sizeof(DLevel) + 1] };
-			byte *dstEnd = &dst.get()[1];
-			dstEnd = DeltaExportItem(dstEnd, sgLevels[i].item);
-			dstEnd = DeltaExportObject(dstEnd, sgLevels[i].object);
-			dstEnd = DeltaExportMonster(dstEnd, sgLevels[i].monster);
-			int size = CompressData(dst.get(), dstEnd);
-			dthread_send_delta(pnum, static_cast<_cmd_id>(i + CMD_DLEVEL_0), std::move(dst), size);
+			// The receiver starts from the same pristine deltas (see delta_init), so untouched levels
+			// can be left out. The first level is always sent since it marks the start of the transfer.
+			if (i != 0 && IsDeltaLevelPristine(sgLevels[i]))
+				continue;
+			DeltaExportLevel(pnum, i);
 		}
 
 		std::unique_ptr<byte[]> dst { new byte[sizeof(DJunk) + 1] };
@@ -2032,10 +2100,21 @@ void DeltaExportData(int pnum)
 
 void delta_init()
 {
+	static bool levelsTracked = false;
+	if (!levelsTracked) {
+		// The deltas are static arrays, they stay allocated for the lifetime of the process
+		TrackExternalMemory(MemoryCategory::Levels, sizeof(sgLevels) + sizeof(sgLevelCache));
+		levelsTracked = true;
+	}
+
 	sgbDeltaChanged = false;
 	memset(&sgJunk, 0xFF, sizeof(sgJunk));
 	memset(sgLevels, 0xFF, sizeof(sgLevels));
 	memset(sgLocals, 0, sizeof(sgLocals));
+	for (DeltaLevelCache &cache : sgLevelCache) {
+		cache.dirty = true;
+		cache.data = nullptr;
+	}
 	deltaload = false;
 }
 
@@ -2044,7 +2123,7 @@ void delta_kill_monster(int mi, Point position, BYTE bLevel)
 	if (!gbIsMultiplayer)
 		return;
 
-	sgbDeltaChanged = true;
+	DeltaLevelChanged(bLevel);
 	DMonsterStr *pD = &sgLevels[bLevel].monster[mi];
 	pD->_mx = position.x;
 	pD->_my = position.y;
@@ -2057,7 +2136,7 @@ void delta_monster_hp(int mi, int hp, BYTE bLevel)
 	if (!gbIsMultiplayer)
 		return;
 
-	sgbDeltaChanged = true;
+	DeltaLevelChanged(bLevel);
 	DMonsterStr *pD = &sgLevels[bLevel].monster[mi];
 	if (pD->_mhitpoints > hp)
 		pD->_mhitpoints = hp;
@@ -2069,7 +2148,7 @@ void delta_sync_monster(const TSyncMonster &monsterSync, uint8_t level)
 		return;
 
 	assert(level < NUMLEVELS);
-	sgbDeltaChanged = true;
+	DeltaLevelChanged(level);
 
 	DMonsterStr &monster = sgLevels[level].monster[monsterSync._mndx];
 	if (monster._mhitpoints == 0)
@@ -2112,7 +2191,7 @@ void DeltaAddItem(int ii)
 		if (item.bCmd != CMD_INVALID)
 			continue;
 
-		sgbDeltaChanged = true;
+		DeltaLevelChanged(currlevel);
 		item.bCmd = CMD_STAND;
 		item.x = Items[ii].position.x;
 		item.y = Items[ii].position.y;
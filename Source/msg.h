@@ -330,6 +330,8 @@ struct TFakeDropPlr {
 struct TSyncHeader {
 	_cmd_id bCmd;
 	uint8_t bLevel;
+	/** Counts the sync messages of a player, lets receivers detect that they missed one */
+	uint8_t bSequence;
 	uint16_t wLen;
 	uint8_t bItemI;
 	uint8_t bItemX;
@@ -351,6 +353,11 @@ struct TSyncHeader {
 	uint8_t bPInvId;
 };
 
+/**
+ * @brief Decoded monster sync record
+ *
+ * On the wire the records are variable length, see sync.cpp.
+ */
 struct TSyncMonster {
 	uint8_t _mndx;
 	uint8_t _mx;
@@ -12,6 +12,7 @@
 #include "DiabloUI/diabloui.h"
 #include "diablo.h"
 #include "dthread.h"
+#include "encrypt.h"
 #include "engine/point.hpp"
 #include "engine/random.hpp"
 #include "menu.h"
@@ -24,6 +25,7 @@
 #include "tmsg.h"
 #include "utils/endian.hpp"
 #include "utils/language.h"
+#include "utils/profiler.hpp"
 #include "utils/stdcompat/cstddef.hpp"
 
 namespace devilution {
@@ -477,6 +479,7 @@ void InitGameInfo()
 	sgGameInitInfo.bTheoQuest = *sgOptions.Gameplay.theoQuest ? 1 : 0;
 	sgGameInitInfo.bCowQuest = *sgOptions.Gameplay.cowQuest ? 1 : 0;
 	sgGameInitInfo.bFriendlyFire = *sgOptions.Gameplay.friendlyFire ? 1 : 0;
+	sgGameInitInfo.deltaCodec = static_cast<uint8_t>(CompressionCodec::Zlib);
 }
 
 void NetSendLoPri(int playerId, const byte *data, size_t size)
@@ -551,6 +554,7 @@ void multi_net_ping()
 
 bool multi_handle_delta()
 {
+	DVL_PROFILE_ZONE("multi_handle_delta");
 	if (gbGameDestroyed) {
 		gbRunGame = false;
 		return false;
@@ -588,6 +592,7 @@ bool multi_handle_delta()
 
 void multi_process_network_packets()
 {
+	DVL_PROFILE_ZONE("multi_process_network_packets");
 	ClearPlayerLeftState();
 	ProcessTmsgs();
 
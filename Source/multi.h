@@ -29,6 +29,11 @@ struct GameData {
 	uint8_t bTheoQuest;
 	uint8_t bCowQuest;
 	uint8_t bFriendlyFire;
+	/**
+	 * CompressionCodec of the level deltas sent to joining players, chosen by the creator of the game.
+	 * Builds without this field leave the padding byte 0, which selects PKWARE like the original game.
+	 */
+	uint8_t deltaCodec;
 };
 
 extern bool gbSomebodyWonGameKludge;
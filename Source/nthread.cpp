@@ -34,6 +34,11 @@ bool sgbTicsOutOfSync;
 char sgbPacketCountdown;
 bool sgbThreadIsRunning;
 SdlThread Thread;
+/** Whether game ticks run back to back, see nthread_init_fast_forward */
+bool FastForward;
+/** Draw a frame every this many fast forwarded game ticks, 0 to never draw */
+int FastForwardRenderInterval;
+int FastForwardTicks;
 
 void NthreadHandler()
 {
@@ -213,6 +218,9 @@ void nthread_ignore_mutex(bool bStart)
 
 bool nthread_has_500ms_passed()
 {
+	if (nthread_is_fast_forward())
+		return true;
+
 	int currentTickCount = SDL_GetTicks();
 	int ticksElapsed = currentTickCount - last_tick;
 	if (!gbIsMultiplayer && ticksElapsed > gnTickDelay * 10) {
@@ -222,10 +230,36 @@ bool nthread_has_500ms_passed()
 	return ticksElapsed >= 0;
 }
 
+void nthread_init_fast_forward(int renderInterval)
+{
+	FastForward = true;
+	FastForwardRenderInterval = renderInterval;
+}
+
+bool nthread_is_fast_forward()
+{
+	return FastForward && !gbIsMultiplayer;
+}
+
+bool nthread_fast_forward_tick()
+{
+	if (FastForwardRenderInterval == 0)
+		return false;
+	FastForwardTicks++;
+	if (FastForwardTicks < FastForwardRenderInterval)
+		return false;
+	FastForwardTicks = 0;
+	return true;
+}
+
 void nthread_UpdateProgressToNextGameTick()
 {
 	if (!gbRunGame || PauseMode != 0 || (!gbIsMultiplayer && gmenu_is_active()) || !gbProcessPlayers || demo::IsRunning()) // if game is not running or paused there is no next gametick in the near future
 		return;
+	if (nthread_is_fast_forward()) {
+		gfProgressToNextGameTick = 0.0; // frames are only drawn right after a game tick
+		return;
+	}
 	int currentTickCount = SDL_GetTicks();
 	int ticksElapsed = last_tick - currentTickCount;
 	if (ticksElapsed <= 0) {
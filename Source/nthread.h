@@ -32,6 +32,17 @@ void nthread_ignore_mutex(bool bStart);
  * @return True if the engine should tick
  */
 bool nthread_has_500ms_passed();
+/**
+ * @brief Run the game ticks of single player games back to back instead of at the tick rate
+ * @param renderInterval Draw a frame every this many game ticks, 0 to never draw
+ */
+void nthread_init_fast_forward(int renderInterval);
+bool nthread_is_fast_forward();
+/**
+ * @brief Counts a fast forwarded game tick
+ * @return True if a frame should be drawn after this tick
+ */
+bool nthread_fast_forward_tick();
 /**
  * @brief Calculates the progress in time to the next game tick
  * @return Progress as a fraction (0.0f to 1.0f)
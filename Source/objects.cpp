@@ -34,6 +34,7 @@
 #include "track.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 
@@ -4887,6 +4888,7 @@ void OperateTrap(Object &trap)
 
 void ProcessObjects()
 {
+	DVL_PROFILE_ZONE("ProcessObjects");
 	for (int i = 0; i < ActiveObjectCount; ++i) {
 		int oi = ActiveObjects[i];
 		switch (Objects[oi]._otype) {
@@ -53,56 +53,6 @@ Uint8 FindBestMatchForColor(SDL_Color *palette, SDL_Color color, int skipFrom, i
 	return best;
 }
 
-/**
- * @brief Generate lookup table for transparency
- *
- * This is based of the same technique found in Quake2.
- *
- * To mimic 50% transparency we figure out what colors in the existing palette are the best match for the combination of any 2 colors.
- * We save this into a lookup table for use during rendering.
- *
- * @param palette The colors to operate on
- * @param skipFrom Do not use colors between this index and skipTo
- * @param skipTo Do not use colors between skipFrom and this index
- * @param toUpdate Only update the first n colors
- */
-void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, int toUpdate = 256)
-{
-	for (int i = 0; i < 256; i++) {
-		for (int j = 0; j < 256; j++) {
-			if (i == j) { // No need to calculate transparency between 2 identical colors
-				paletteTransparencyLookup[i][j] = j;
-				continue;
-			}
-			if (i > j) { // Half the blends will be mirror identical ([i][j] is the same as [j][i]), so simply copy the existing combination.
-				paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i];
-				continue;
-			}
-			if (i > toUpdate && j > toUpdate) {
-				continue;
-			}
-
-			SDL_Color blendedColor;
-			blendedColor.r = ((int)palette[i].r + (int)palette[j].r) / 2;
-			blendedColor.g = ((int)palette[i].g + (int)palette[j].g) / 2;
-			blendedColor.b = ((int)palette[i].b + (int)palette[j].b) / 2;
-			Uint8 best = FindBestMatchForColor(palette, blendedColor, skipFrom, skipTo);
-			paletteTransparencyLookup[i][j] = best;
-		}
-	}
-
-	for (unsigned i = 0; i < 256; ++i) {
-		for (unsigned j = 0; j < 256; ++j) {
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-			const std::uint16_t index = i | (j << 8);
-#else
-			const std::uint16_t index = j | (i << 8);
-#endif
-			paletteTransparencyLookupBlack16[index] = paletteTransparencyLookup[0][i] | (paletteTransparencyLookup[0][j] << 8);
-		}
-	}
-}
-
 /**
  * @brief Cycle the given range of colors in the palette
  * @param from First color index of the range
@@ -167,6 +117,56 @@ void CycleColorsReverse(int from, int to)
 
 } // namespace
 
+/**
+ * @brief Generate lookup table for transparency
+ *
+ * This is based of the same technique found in Quake2.
+ *
+ * To mimic 50% transparency we figure out what colors in the existing palette are the best match for the combination of any 2 colors.
+ * We save this into a lookup table for use during rendering.
+ *
+ * @param palette The colors to operate on
+ * @param skipFrom Do not use colors between this index and skipTo
+ * @param skipTo Do not use colors between skipFrom and this index
+ * @param toUpdate Only update the first n colors
+ */
+void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, int toUpdate)
+{
+	for (int i = 0; i < 256; i++) {
+		for (int j = 0; j < 256; j++) {
+			if (i == j) { // No need to calculate transparency between 2 identical colors
+				paletteTransparencyLookup[i][j] = j;
+				continue;
+			}
+			if (i > j) { // Half the blends will be mirror identical ([i][j] is the same as [j][i]), so simply copy the existing combination.
+				paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i];
+				continue;
+			}
+			if (i > toUpdate && j > toUpdate) {
+				continue;
+			}
+
+			SDL_Color blendedColor;
+			blendedColor.r = ((int)palette[i].r + (int)palette[j].r) / 2;
+			blendedColor.g = ((int)palette[i].g + (int)palette[j].g) / 2;
+			blendedColor.b = ((int)palette[i].b + (int)palette[j].b) / 2;
+			Uint8 best = FindBestMatchForColor(palette, blendedColor, skipFrom, skipTo);
+			paletteTransparencyLookup[i][j] = best;
+		}
+	}
+
+	for (unsigned i = 0; i < 256; ++i) {
+		for (unsigned j = 0; j < 256; ++j) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			const std::uint16_t index = i | (j << 8);
+#else
+			const std::uint16_t index = j | (i << 8);
+#endif
+			paletteTransparencyLookupBlack16[index] = paletteTransparencyLookup[0][i] | (paletteTransparencyLookup[0][j] << 8);
+		}
+	}
+}
+
 void palette_update(int first, int ncolor)
 {
 	assert(Palette);
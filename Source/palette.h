@@ -48,6 +48,7 @@ extern Uint8 paletteTransparencyLookup[256][256];
  */
 extern uint16_t paletteTransparencyLookupBlack16[65536];
 
+void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, int toUpdate = 256);
 void palette_update(int first = 0, int ncolor = 256);
 void palette_init();
 void LoadPalette(const char *pszFileName, bool blend = true);
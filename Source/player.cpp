@@ -31,6 +31,8 @@
 #include "towners.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/memory_stats.hpp"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 
@@ -363,6 +365,7 @@ void StartWalk(int pnum, Displacement vel, Direction dir, bool pmWillBeCalled)
 
 void SetPlayerGPtrs(const char *path, std::unique_ptr<byte[]> &data, std::array<std::optional<CelSprite>, 8> &anim, int width)
 {
+	MemoryCategoryScope memoryScope(MemoryCategory::Players);
 	data = nullptr;
 	data = LoadFileInMem(path);
 	if (data == nullptr && gbQuietMode)
@@ -3210,6 +3213,7 @@ void StartWarpLvl(int pnum, int pidx)
 
 void ProcessPlayers()
 {
+	DVL_PROFILE_ZONE("ProcessPlayers");
 	if ((DWORD)MyPlayerId >= MAX_PLRS) {
 		app_fatal("ProcessPlayers: illegal player %i", MyPlayerId);
 	}
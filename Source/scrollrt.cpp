@@ -12,6 +12,7 @@
 #include "dead.h"
 #include "doom.h"
 #include "dx.h"
+#include "engine/demomode.h"
 #include "engine/render/cel_render.hpp"
 #include "engine/render/cl2_render.hpp"
 #include "engine/render/dun_render.hpp"
@@ -36,6 +37,8 @@
 #include "utils/display.h"
 #include "utils/endian.hpp"
 #include "utils/log.hpp"
+#include "utils/memory_stats.hpp"
+#include "utils/profiler.hpp"
 
 #ifdef _DEBUG
 #include "debug.h"
@@ -918,6 +921,7 @@ void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosit
  */
 void DrawFloor(const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns)
 {
+	DVL_PROFILE_ZONE("DrawFloor");
 	for (int i = 0; i < rows; i++) {
 		for (int j = 0; j < columns; j++) {
 			if (InDungeonBounds(tilePosition)) {
@@ -965,6 +969,7 @@ void DrawFloor(const Surface &out, Point tilePosition, Point targetBufferPositio
  */
 void DrawTileContent(const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns)
 {
+	DVL_PROFILE_ZONE("DrawTileContent");
 	// Keep evaluating until MicroTiles can't affect screen
 	rows += MicroTileLen;
 	memset(dRendered, 0, sizeof(dRendered));
@@ -1011,61 +1016,6 @@ void DrawTileContent(const Surface &out, Point tilePosition, Point targetBufferP
 	}
 }
 
-/**
- * @brief Scale up the top left part of the buffer 2x.
- */
-void Zoom(const Surface &out)
-{
-	int viewportWidth = out.w();
-	int viewportOffsetX = 0;
-	if (CanPanelsCoverView()) {
-		if (chrflag || QuestLogIsOpen) {
-			viewportWidth -= SPANEL_WIDTH;
-			viewportOffsetX = SPANEL_WIDTH;
-		} else if (invflag || sbookflag) {
-			viewportWidth -= SPANEL_WIDTH;
-		}
-	}
-
-	// We round to even for the source width and height.
-	// If the width / height was odd, we copy just one extra pixel / row later on.
-	const int srcWidth = (viewportWidth + 1) / 2;
-	const int doubleableWidth = viewportWidth / 2;
-	const int srcHeight = (out.h() + 1) / 2;
-	const int doubleableHeight = out.h() / 2;
-
-	BYTE *src = out.at(srcWidth - 1, srcHeight - 1);
-	BYTE *dst = out.at(viewportOffsetX + viewportWidth - 1, out.h() - 1);
-	const bool oddViewportWidth = (viewportWidth % 2) == 1;
-
-	for (int hgt = 0; hgt < doubleableHeight; hgt++) {
-		// Double the pixels in the line.
-		for (int i = 0; i < doubleableWidth; i++) {
-			*dst-- = *src;
-			*dst-- = *src;
-			--src;
-		}
-
-		// Copy a single extra pixel if the output width is odd.
-		if (oddViewportWidth) {
-			*dst-- = *src;
-			--src;
-		}
-
-		// Skip the rest of the source line.
-		src -= (out.pitch() - srcWidth);
-
-		// Double the line.
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
-
-		// Skip the rest of the destination line.
-		dst -= 2 * out.pitch() - viewportWidth;
-	}
-	if ((out.h() % 2) == 1) {
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
-	}
-}
-
 Displacement tileOffset;
 Displacement tileShift;
 int tileColums;
@@ -1078,6 +1028,7 @@ int tileRows;
  */
 void DrawGame(const Surface &fullOut, Point position)
 {
+	DVL_PROFILE_ZONE("DrawGame");
 	// Limit rendering to the view area
 	const Surface &out = zoomflag
 	    ? fullOut.subregionY(0, gnViewportHeight)
@@ -1408,6 +1359,58 @@ void DrawMain(int dwHgt, bool drawDesc, bool drawHp, bool drawMana, bool drawSba
 
 } // namespace
 
+void Zoom(const Surface &out)
+{
+	int viewportWidth = out.w();
+	int viewportOffsetX = 0;
+	if (CanPanelsCoverView()) {
+		if (chrflag || QuestLogIsOpen) {
+			viewportWidth -= SPANEL_WIDTH;
+			viewportOffsetX = SPANEL_WIDTH;
+		} else if (invflag || sbookflag) {
+			viewportWidth -= SPANEL_WIDTH;
+		}
+	}
+
+	// We round to even for the source width and height.
+	// If the width / height was odd, we copy just one extra pixel / row later on.
+	const int srcWidth = (viewportWidth + 1) / 2;
+	const int doubleableWidth = viewportWidth / 2;
+	const int srcHeight = (out.h() + 1) / 2;
+	const int doubleableHeight = out.h() / 2;
+
+	BYTE *src = out.at(srcWidth - 1, srcHeight - 1);
+	BYTE *dst = out.at(viewportOffsetX + viewportWidth - 1, out.h() - 1);
+	const bool oddViewportWidth = (viewportWidth % 2) == 1;
+
+	for (int hgt = 0; hgt < doubleableHeight; hgt++) {
+		// Double the pixels in the line.
+		for (int i = 0; i < doubleableWidth; i++) {
+			*dst-- = *src;
+			*dst-- = *src;
+			--src;
+		}
+
+		// Copy a single extra pixel if the output width is odd.
+		if (oddViewportWidth) {
+			*dst-- = *src;
+			--src;
+		}
+
+		// Skip the rest of the source line.
+		src -= (out.pitch() - srcWidth);
+
+		// Double the line.
+		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
+
+		// Skip the rest of the destination line.
+		dst -= 2 * out.pitch() - viewportWidth;
+	}
+	if ((out.h() % 2) == 1) {
+		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
+	}
+}
+
 Displacement GetOffsetForWalking(const AnimationInfo &animationInfo, const Direction dir, bool cameraMode /*= false*/)
 {
 	// clang-format off
@@ -1686,6 +1689,9 @@ void DrawAndBlit()
 		return;
 	}
 
+	if (demo::IsTiming())
+		demo::TimeFrameStart();
+
 	int hgt = 0;
 	bool ddsdesc = false;
 	bool ctrlPan = false;
@@ -1743,6 +1749,8 @@ void DrawAndBlit()
 	}
 
 	DrawFPS(out);
+	profiler::DrawOverlay(out);
+	DrawMemoryOverlay(out);
 
 	unlock_buf(0);
 
@@ -1754,6 +1762,10 @@ void DrawAndBlit()
 	drawmanaflag = false;
 	drawbtnflag = false;
 	drawsbarflag = false;
+
+	if (demo::IsTiming())
+		demo::TimeFrameEnd();
+	profiler::FrameMark();
 }
 
 } // namespace devilution
@@ -75,6 +75,11 @@ void CalcTileOffset(int *offsetX, int *offsetY);
 void TilesInView(int *columns, int *rows);
 void CalcViewportGeometry();
 
+/**
+ * @brief Scale up the top left part of the buffer 2x.
+ */
+void Zoom(const Surface &out);
+
 /**
  * @brief Render the whole screen black
  */
@@ -17,16 +17,16 @@ uint32_t SHA1CircularShift(uint32_t word, size_t bits)
 {
 	// The SHA-like algorithm as originally implemented treated word as a signed value and used arithmetic right shifts
 	//  (sign-extending). This results in the high 32-`bits` bits being set to 1.
-	if ((word & (1 << 31)) != 0)
-		return (0xFFFFFFFF << bits) | (word >> (32 - bits));
-	return (word << bits) | (word >> (32 - bits));
+	// The sign bit of the hashed data is effectively random, so this is computed without a branch.
+	const uint32_t signExtension = (0 - (word >> 31)) << bits;
+	return (word << bits) | (word >> (32 - bits)) | signExtension;
 }
 
-void SHA1ProcessMessageBlock(SHA1Context *context)
+void SHA1ProcessMessageBlock(SHA1Context *context, const uint32_t data[BlockSize])
 {
 	std::uint32_t w[80];
 
-	memcpy(w, context->buffer, BlockSize * sizeof(uint32_t));
+	memcpy(w, data, BlockSize * sizeof(uint32_t));
 	for (int i = 16; i < 80; i++) {
 		w[i] = w[i - 16] ^ w[i - 14] ^ w[i - 8] ^ w[i - 3];
 	}
@@ -89,8 +89,7 @@ void SHA1Result(SHA1Context &context, uint32_t messageDigest[SHA1HashSize])
 
 void SHA1Calculate(SHA1Context &context, const uint32_t data[BlockSize])
 {
-	memcpy(&context.buffer[0], data, BlockSize * sizeof(uint32_t));
-	SHA1ProcessMessageBlock(&context);
+	SHA1ProcessMessageBlock(&context, data);
 }
 
 } // namespace devilution
@@ -21,6 +21,7 @@
 #include "options.h"
 #include "utils/log.hpp"
 #include "utils/math.h"
+#include "utils/memory_stats.hpp"
 #include "utils/sdl_mutex.h"
 #include "utils/stdcompat/algorithm.hpp"
 #include "utils/stdcompat/optional.hpp"
@@ -151,6 +152,7 @@ void snd_play_snd(TSnd *pSnd, int lVolume, int lPan)
 
 std::unique_ptr<TSnd> sound_file_load(const char *path, bool stream)
 {
+	MemoryCategoryScope memoryScope(MemoryCategory::Sound);
 
 	auto snd = std::make_unique<TSnd>();
 	snd->start_tc = SDL_GetTicks() - 80 - 1;
@@ -8,11 +8,34 @@
 #include "gendung.h"
 #include "monster.h"
 #include "player.h"
+#include "sync.h"
 
 namespace devilution {
 
 namespace {
 
+/**
+ * Monster sync records are sent as _mndx, flags, _mdelta, [_mx, _my], [_menemy], [_mhitpoints].
+ * The low bits of flags tell which of the bracketed fields are present and the high nibble holds
+ * mWhoHit. An omitted field repeats the value the sending player last sent for that monster. The
+ * hit points are zigzag encoded as a varint.
+ */
+enum sync_monster_field : uint8_t {
+	// clang-format off
+	SYNC_POSITION  = 1 << 0,
+	SYNC_ENEMY     = 1 << 1,
+	SYNC_HITPOINTS = 1 << 2,
+	SYNC_ALL       = SYNC_POSITION | SYNC_ENEMY | SYNC_HITPOINTS,
+	// clang-format on
+};
+
+/** Monsters are sent in full at least this often, so that players who joined later pick up their state */
+constexpr uint8_t FullSyncInterval = 8;
+
+/** What we last sent for each monster */
+SyncPeerState sgSyncSent;
+/** What each player last sent for each monster */
+SyncPeerState sgSyncReceived[MAX_PLRS];
 uint16_t sgnMonsterPriority[MAXMONSTERS];
 int sgnMonsters;
 uint16_t sgwLRU[MAXMONSTERS];
@@ -247,12 +270,124 @@ bool IsTSyncMonsterValidate(const TSyncMonster &monsterSync)
 
 } // namespace
 
+void InvalidateSyncPeer(SyncPeerState &peer)
+{
+	for (SyncMonsterState &state : peer.monsters)
+		state.valid = false;
+}
+
+byte *EncodeSyncMonster(byte *dst, SyncPeerState &sent, const TSyncMonster &monsterSync)
+{
+	SyncMonsterState &state = sent.monsters[monsterSync._mndx];
+	uint8_t fields = SYNC_ALL;
+	if (state.valid && state.sendsSinceFull < FullSyncInterval) {
+		fields = 0;
+		if (state.x != monsterSync._mx || state.y != monsterSync._my)
+			fields |= SYNC_POSITION;
+		if (state.enemy != monsterSync._menemy)
+			fields |= SYNC_ENEMY;
+		if (state.hitpoints != monsterSync._mhitpoints)
+			fields |= SYNC_HITPOINTS;
+		state.sendsSinceFull++;
+	} else {
+		state.valid = true;
+		state.sendsSinceFull = 0;
+	}
+	state.x = monsterSync._mx;
+	state.y = monsterSync._my;
+	state.enemy = monsterSync._menemy;
+	state.hitpoints = monsterSync._mhitpoints;
+
+	*dst++ = static_cast<byte>(monsterSync._mndx);
+	*dst++ = static_cast<byte>(fields | ((monsterSync.mWhoHit & 0x0F) << 4));
+	*dst++ = static_cast<byte>(monsterSync._mdelta);
+	if ((fields & SYNC_POSITION) != 0) {
+		*dst++ = static_cast<byte>(monsterSync._mx);
+		*dst++ = static_cast<byte>(monsterSync._my);
+	}
+	if ((fields & SYNC_ENEMY) != 0)
+		*dst++ = static_cast<byte>(monsterSync._menemy);
+	if ((fields & SYNC_HITPOINTS) != 0) {
+		auto hitpoints = static_cast<uint32_t>(monsterSync._mhitpoints);
+		uint32_t zigzag = (hitpoints << 1) ^ (0 - (hitpoints >> 31));
+		while (zigzag >= 0x80) {
+			*dst++ = static_cast<byte>(zigzag | 0x80);
+			zigzag >>= 7;
+		}
+		*dst++ = static_cast<byte>(zigzag);
+	}
+	return dst;
+}
+
+const byte *DecodeSyncMonster(const byte *src, const byte *end, SyncPeerState &peer, TSyncMonster &monsterSync, bool &complete)
+{
+	if (end - src < 3)
+		return nullptr;
+	monsterSync._mndx = static_cast<uint8_t>(*src++);
+	const auto flags = static_cast<uint8_t>(*src++);
+	monsterSync.mWhoHit = flags >> 4;
+	monsterSync._mdelta = static_cast<uint8_t>(*src++);
+	if (monsterSync._mndx >= MAXMONSTERS)
+		return nullptr;
+
+	SyncMonsterState state = peer.monsters[monsterSync._mndx];
+	if ((flags & SYNC_POSITION) != 0) {
+		if (end - src < 2)
+			return nullptr;
+		state.x = static_cast<uint8_t>(*src++);
+		state.y = static_cast<uint8_t>(*src++);
+	}
+	if ((flags & SYNC_ENEMY) != 0) {
+		if (src == end)
+			return nullptr;
+		state.enemy = static_cast<uint8_t>(*src++);
+	}
+	if ((flags & SYNC_HITPOINTS) != 0) {
+		uint32_t zigzag = 0;
+		for (int shift = 0;; shift += 7) {
+			if (src == end || shift > 28)
+				return nullptr;
+			const auto value = static_cast<uint8_t>(*src++);
+			zigzag |= static_cast<uint32_t>(value & 0x7F) << shift;
+			if ((value & 0x80) == 0)
+				break;
+		}
+		state.hitpoints = static_cast<int32_t>((zigzag >> 1) ^ (0 - (zigzag & 1)));
+	}
+
+	complete = state.valid || (flags & SYNC_ALL) == SYNC_ALL;
+	if (!complete)
+		return src;
+
+	state.valid = true;
+	peer.monsters[monsterSync._mndx] = state;
+	monsterSync._mx = state.x;
+	monsterSync._my = state.y;
+	monsterSync._menemy = state.enemy;
+	monsterSync._mhitpoints = state.hitpoints;
+	return src;
+}
+
+void BeginSyncMessage(SyncPeerState &peer, uint8_t level, uint8_t sequence)
+{
+	if (sequence != peer.nextSequence || level != peer.level) {
+		InvalidateSyncPeer(peer);
+		peer.level = level;
+	}
+	peer.nextSequence = sequence + 1;
+}
+
 uint32_t sync_all_monsters(byte *pbBuf, uint32_t dwMaxLen)
 {
+	if (sgSyncSent.level != currlevel) {
+		InvalidateSyncPeer(sgSyncSent);
+		sgSyncSent.level = currlevel;
+	}
+
 	if (ActiveMonsterCount < 1) {
 		return dwMaxLen;
 	}
-	if (dwMaxLen < sizeof(TSyncHeader) + sizeof(TSyncMonster)) {
+	if (dwMaxLen < sizeof(TSyncHeader) + MaxSyncMonsterSize) {
 		return dwMaxLen;
 	}
 
@@ -262,13 +397,14 @@ uint32_t sync_all_monsters(byte *pbBuf, uint32_t dwMaxLen)
 
 	pHdr->bCmd = CMD_SYNCDATA;
 	pHdr->bLevel = currlevel;
+	pHdr->bSequence = sgSyncSent.nextSequence++;
 	pHdr->wLen = 0;
 	SyncPlrInv(pHdr);
 	assert(dwMaxLen <= 0xffff);
 	SyncOneMonster();
 
-	for (int i = 0; i < ActiveMonsterCount && dwMaxLen >= sizeof(TSyncMonster); i++) {
-		auto &monsterSync = *reinterpret_cast<TSyncMonster *>(pbBuf);
+	for (int i = 0; i < ActiveMonsterCount && dwMaxLen >= MaxSyncMonsterSize; i++) {
+		TSyncMonster monsterSync;
 		bool sync = false;
 		if (i < 2) {
 			sync = SyncMonsterActive2(monsterSync);
@@ -279,9 +415,11 @@ uint32_t sync_all_monsters(byte *pbBuf, uint32_t dwMaxLen)
 		if (!sync) {
 			break;
 		}
-		pbBuf += sizeof(TSyncMonster);
-		pHdr->wLen += sizeof(TSyncMonster);
-		dwMaxLen -= sizeof(TSyncMonster);
+		byte *end = EncodeSyncMonster(pbBuf, sgSyncSent, monsterSync);
+		const auto size = static_cast<uint32_t>(end - pbBuf);
+		pbBuf = end;
+		pHdr->wLen += size;
+		dwMaxLen -= size;
 	}
 
 	return dwMaxLen;
@@ -293,31 +431,38 @@ uint32_t OnSyncData(const TCmd *pCmd, int pnum)
 
 	assert(gbBufferMsgs != 2);
 
-	if (gbBufferMsgs == 1) {
-		return header.wLen + sizeof(header);
-	}
 	if (pnum == MyPlayerId) {
 		return header.wLen + sizeof(header);
 	}
 
-	assert(header.wLen % sizeof(TSyncMonster) == 0);
-	int monsterCount = header.wLen / sizeof(TSyncMonster);
+	// Records are decoded even while buffering messages, the next ones may refer to their values
+	SyncPeerState &peer = sgSyncReceived[pnum];
+	BeginSyncMessage(peer, header.bLevel, header.bSequence);
 
 	uint8_t level = header.bLevel;
+	const bool apply = gbBufferMsgs != 1 && level < NUMLEVELS;
+
+	const auto *src = reinterpret_cast<const byte *>(pCmd + sizeof(header));
+	const byte *end = src + header.wLen;
+	while (src != end) {
+		TSyncMonster monsterSync;
+		bool complete;
+		src = DecodeSyncMonster(src, end, peer, monsterSync, complete);
+		if (src == nullptr) {
+			InvalidateSyncPeer(peer);
+			break;
+		}
+		if (!complete || !apply)
+			continue;
 
-	if (level < NUMLEVELS) {
-		const auto *monsterSyncs = reinterpret_cast<const TSyncMonster *>(pCmd + sizeof(header));
-
-		for (int i = 0; i < monsterCount; i++) {
-			if (!IsTSyncMonsterValidate(monsterSyncs[i]))
-				continue;
-
-			if (currlevel == level) {
-				SyncMonster(pnum, monsterSyncs[i]);
-			}
+		if (!IsTSyncMonsterValidate(monsterSync))
+			continue;
 
-			delta_sync_monster(monsterSyncs[i], level);
+		if (currlevel == level) {
+			SyncMonster(pnum, monsterSync);
 		}
+
+		delta_sync_monster(monsterSync, level);
 	}
 
 	return header.wLen + sizeof(header);
@@ -327,6 +472,14 @@ void sync_init()
 {
 	sgnMonsters = 16 * MyPlayerId;
 	memset(sgwLRU, 255, sizeof(sgwLRU));
+	sgSyncSent.level = UINT8_MAX;
+	sgSyncSent.nextSequence = 0;
+	InvalidateSyncPeer(sgSyncSent);
+	for (SyncPeerState &peer : sgSyncReceived) {
+		peer.level = UINT8_MAX;
+		peer.nextSequence = 0;
+		InvalidateSyncPeer(peer);
+	}
 }
 
 } // namespace devilution
@@ -7,10 +7,52 @@
 
 #include <cstdint>
 
+#include "monster.h"
+#include "msg.h"
 #include "utils/stdcompat/cstddef.hpp"
 
 namespace devilution {
 
+/** Largest encoded size of a monster sync record */
+constexpr uint32_t MaxSyncMonsterSize = 3 + 2 + 1 + 5;
+
+struct SyncMonsterState {
+	bool valid;
+	uint8_t sendsSinceFull;
+	uint8_t x;
+	uint8_t y;
+	uint8_t enemy;
+	int32_t hitpoints;
+};
+
+/** The monster values last sent to or received from a player, omitted fields of a record repeat them */
+struct SyncPeerState {
+	uint8_t level;
+	uint8_t nextSequence;
+	SyncMonsterState monsters[MAXMONSTERS];
+};
+
+/**
+ * @brief Writes a monster sync record, leaving out the fields that didn't change since the last one
+ * @param sent What was sent so far, updated with the values of this record
+ * @return The position after the record
+ */
+byte *EncodeSyncMonster(byte *dst, SyncPeerState &sent, const TSyncMonster &monsterSync);
+
+/**
+ * @brief Reads one monster sync record and fills in the omitted fields
+ * @param complete Set to false if an omitted field is not known, the record must then be ignored
+ * @return The position after the record or nullptr if it is malformed
+ */
+const byte *DecodeSyncMonster(const byte *src, const byte *end, SyncPeerState &peer, TSyncMonster &monsterSync, bool &complete);
+
+/**
+ * @brief Forgets what a player sent if the message doesn't directly follow the last one or is for another level
+ */
+void BeginSyncMessage(SyncPeerState &peer, uint8_t level, uint8_t sequence);
+
+void InvalidateSyncPeer(SyncPeerState &peer);
+
 uint32_t sync_all_monsters(byte *pbBuf, uint32_t dwMaxLen);
 uint32_t OnSyncData(const TCmd *pCmd, int pnum);
 void sync_init();
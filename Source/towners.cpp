@@ -8,6 +8,7 @@
 #include "minitext.h"
 #include "stores.h"
 #include "utils/language.h"
+#include "utils/profiler.hpp"
 
 namespace devilution {
 namespace {
@@ -846,6 +847,7 @@ void FreeTownerGFX()
 
 void ProcessTowners()
 {
+	DVL_PROFILE_ZONE("ProcessTowners");
 	// BUGFIX: should be `i < numtowners`, was `i < NUM_TOWNERS`
 	for (auto &towner : Towners) {
 		if (towner._ttype == TOWN_DEADGUY) {
@@ -37,6 +37,9 @@
 namespace devilution {
 
 extern SDLSurfaceUniquePtr RendererTextureSurface; /** defined in dx.cpp */
+#ifndef USE_SDL1
+extern SDLSurfaceUniquePtr OffscreenSurface; /** defined in dx.cpp */
+#endif
 
 Uint16 gnScreenWidth;
 Uint16 gnScreenHeight;
@@ -59,7 +62,16 @@ Uint16 GetViewportHeight()
 
 namespace {
 
+/** Whether we render to memory only, see InitOffscreenRendering */
+bool OffscreenRendering;
+
 #ifndef USE_SDL1
+/** Whether the output is scaled through an SDL renderer */
+bool UseRenderer()
+{
+	return *sgOptions.Graphics.upscale && !OffscreenRendering;
+}
+
 void CalculatePreferredWindowSize(int &width, int &height)
 {
 	SDL_DisplayMode mode;
@@ -106,7 +118,7 @@ Size GetPreferredWindowSize()
 	Size windowSize = *sgOptions.Graphics.resolution;
 
 #ifndef USE_SDL1
-	if (*sgOptions.Graphics.upscale && *sgOptions.Graphics.fitToScreen) {
+	if (UseRenderer() && *sgOptions.Graphics.fitToScreen) {
 		CalculatePreferredWindowSize(windowSize.width, windowSize.height);
 	}
 #endif
@@ -139,6 +151,24 @@ float GetDpiScalingFactor()
 #endif
 }
 
+void InitOffscreenRendering()
+{
+	OffscreenRendering = true;
+	// SDL keeps the window in memory and discards the sound
+#ifdef USE_SDL1
+	SDL_putenv(const_cast<char *>("SDL_VIDEODRIVER=dummy"));
+	SDL_putenv(const_cast<char *>("SDL_AUDIODRIVER=dummy"));
+#else
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", /*overwrite=*/1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", /*overwrite=*/1);
+#endif
+}
+
+bool IsOffscreenRendering()
+{
+	return OffscreenRendering;
+}
+
 #ifdef USE_SDL1
 void SetVideoMode(int width, int height, int bpp, uint32_t flags)
 {
@@ -234,18 +264,18 @@ bool SpawnWindow(const char *lpWindowName)
 
 #ifdef USE_SDL1
 	SDL_WM_SetCaption(lpWindowName, WINDOW_ICON_NAME);
-	SetVideoModeToPrimary(*sgOptions.Graphics.fullscreen, windowSize.width, windowSize.height);
+	SetVideoModeToPrimary(*sgOptions.Graphics.fullscreen && !OffscreenRendering, windowSize.width, windowSize.height);
 	if (*sgOptions.Gameplay.grabInput)
 		SDL_WM_GrabInput(SDL_GRAB_ON);
 	atexit(SDL_VideoQuit); // Without this video mode is not restored after fullscreen.
 #else
 	int flags = SDL_WINDOW_ALLOW_HIGHDPI;
-	if (*sgOptions.Graphics.upscale) {
+	if (UseRenderer()) {
 		if (*sgOptions.Graphics.fullscreen) {
 			flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
 		}
 		flags |= SDL_WINDOW_RESIZABLE;
-	} else if (*sgOptions.Graphics.fullscreen) {
+	} else if (*sgOptions.Graphics.fullscreen && !OffscreenRendering) {
 		flags |= SDL_WINDOW_FULLSCREEN;
 	}
 
@@ -317,7 +347,7 @@ void ReinitializeRenderer()
 		renderer = nullptr;
 	}
 
-	if (*sgOptions.Graphics.upscale) {
+	if (UseRenderer()) {
 		Uint32 rendererFlags = 0;
 
 		if (*sgOptions.Graphics.vSync) {
@@ -361,6 +391,8 @@ void ReinitializeRenderer()
 		Size windowSize = {};
 		SDL_GetWindowSize(ghMainWnd, &windowSize.width, &windowSize.height);
 		AdjustToScreenGeometry(windowSize);
+		if (OffscreenRendering)
+			OffscreenSurface = SDLWrap::CreateRGBSurfaceWithFormat(0, gnScreenWidth, gnScreenHeight, 32, SDL_PIXELFORMAT_RGB888);
 	}
 #endif
 }
@@ -428,6 +460,8 @@ SDL_Surface *GetOutputSurface()
 #else
 	if (renderer != nullptr)
 		return RendererTextureSurface.get();
+	if (OffscreenSurface)
+		return OffscreenSurface.get();
 	SDL_Surface *ret = SDL_GetWindowSurface(ghMainWnd);
 	if (ret == nullptr)
 		ErrSdl();
@@ -33,6 +33,15 @@ void SetVideoModeToPrimary(bool fullscreen, int width, int height);
 
 bool IsFullScreen();
 
+/**
+ * @brief Render to memory only through SDL's dummy video and audio drivers
+ *
+ * No display server, GPU or sound device is needed and presenting a frame only dumps it if requested.
+ * Must be called before SpawnWindow.
+ */
+void InitOffscreenRendering();
+bool IsOffscreenRendering();
+
 // Returns:
 // SDL1: Video surface.
 // SDL2, no upscale: Window surface.
@@ -0,0 +1,222 @@
+#include "utils/memory_stats.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <fmt/format.h>
+
+#include "engine/render/text_render.hpp"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+bool ShowMemoryOverlay = false;
+
+#ifdef MEMORY_ACCOUNTING
+namespace {
+
+constexpr size_t NumCategories = enum_size<MemoryCategory>::value;
+
+std::array<std::atomic<size_t>, NumCategories> CurrentBytes;
+std::array<std::atomic<size_t>, NumCategories> PeakBytes;
+thread_local MemoryCategory CurrentCategory = MemoryCategory::Other;
+
+/** Stored in front of every allocation, so it can be freed from the right category */
+struct alignas(std::max_align_t) AllocationHeader {
+	size_t size;
+	MemoryCategory category;
+};
+
+void AddBytes(MemoryCategory category, size_t bytes)
+{
+	const auto index = static_cast<size_t>(category);
+	const size_t current = CurrentBytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	size_t peak = PeakBytes[index].load(std::memory_order_relaxed);
+	while (current > peak && !PeakBytes[index].compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+	}
+}
+
+void SubtractBytes(MemoryCategory category, size_t bytes)
+{
+	CurrentBytes[static_cast<size_t>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void *TrackedAlloc(size_t size) noexcept
+{
+	if (size > SIZE_MAX - sizeof(AllocationHeader))
+		return nullptr;
+	void *block = std::malloc(sizeof(AllocationHeader) + size);
+	if (block == nullptr)
+		return nullptr;
+	auto *header = new (block) AllocationHeader { size, CurrentCategory };
+	AddBytes(header->category, size);
+	return header + 1;
+}
+
+void TrackedFree(void *ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	AllocationHeader *header = static_cast<AllocationHeader *>(ptr) - 1;
+	SubtractBytes(header->category, header->size);
+	std::free(header);
+}
+
+void *TrackedAllocOrFail(size_t size)
+{
+	void *ptr = TrackedAlloc(size);
+	if (ptr == nullptr) {
+#ifdef __cpp_exceptions
+		throw std::bad_alloc();
+#else
+		std::abort();
+#endif
+	}
+	return ptr;
+}
+
+} // namespace
+
+MemoryCategoryScope::MemoryCategoryScope(MemoryCategory category)
+    : previous_(CurrentCategory)
+{
+	CurrentCategory = category;
+}
+
+MemoryCategoryScope::~MemoryCategoryScope()
+{
+	CurrentCategory = previous_;
+}
+
+void TrackExternalMemory(MemoryCategory category, std::ptrdiff_t bytes)
+{
+	if (bytes >= 0)
+		AddBytes(category, static_cast<size_t>(bytes));
+	else
+		SubtractBytes(category, static_cast<size_t>(-bytes));
+}
+
+MemoryUsage GetMemoryUsage(MemoryCategory category)
+{
+	const auto index = static_cast<size_t>(category);
+	return { CurrentBytes[index].load(std::memory_order_relaxed), PeakBytes[index].load(std::memory_order_relaxed) };
+}
+#else
+void TrackExternalMemory(MemoryCategory /*category*/, std::ptrdiff_t /*bytes*/)
+{
+}
+
+MemoryUsage GetMemoryUsage(MemoryCategory /*category*/)
+{
+	return { 0, 0 };
+}
+#endif
+
+const char *MemoryCategoryName(MemoryCategory category)
+{
+	switch (category) {
+	case MemoryCategory::Other:
+		return "Other";
+	case MemoryCategory::Dungeon:
+		return "Dungeon";
+	case MemoryCategory::Monsters:
+		return "Monsters";
+	case MemoryCategory::Players:
+		return "Players";
+	case MemoryCategory::Missiles:
+		return "Missiles";
+	case MemoryCategory::Items:
+		return "Items";
+	case MemoryCategory::Sound:
+		return "Sound";
+	case MemoryCategory::Fonts:
+		return "Fonts";
+	case MemoryCategory::Levels:
+		return "Levels";
+	}
+	return "Unknown";
+}
+
+void LogMemoryUsage()
+{
+#ifdef MEMORY_ACCOUNTING
+	size_t totalBytes = 0;
+	for (auto category : enum_values<MemoryCategory>()) {
+		const MemoryUsage usage = GetMemoryUsage(category);
+		totalBytes += usage.currentBytes;
+		Log("Memory {}: {} KiB, peak {} KiB", MemoryCategoryName(category), usage.currentBytes / 1024, usage.peakBytes / 1024);
+	}
+	Log("Memory total: {} KiB", totalBytes / 1024);
+#endif
+}
+
+void DrawMemoryOverlay(const Surface &out)
+{
+	if (!ShowMemoryOverlay)
+		return;
+
+	constexpr int LineHeight = 12;
+	Rectangle line { { 0, 88 }, { out.w() - 8, LineHeight } };
+	for (auto category : enum_values<MemoryCategory>()) {
+		const MemoryUsage usage = GetMemoryUsage(category);
+		DrawString(out, fmt::format("{} {:.1f} MiB, peak {:.1f} MiB", MemoryCategoryName(category), usage.currentBytes / 1048576.0, usage.peakBytes / 1048576.0), line, UiFlags::ColorWhite | UiFlags::AlignRight);
+		line.position.y += LineHeight;
+	}
+}
+
+} // namespace devilution
+
+#ifdef MEMORY_ACCOUNTING
+void *operator new(std::size_t size)
+{
+	return devilution::TrackedAllocOrFail(size);
+}
+
+void *operator new[](std::size_t size)
+{
+	return devilution::TrackedAllocOrFail(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t & /*tag*/) noexcept
+{
+	return devilution::TrackedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t & /*tag*/) noexcept
+{
+	return devilution::TrackedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+
+void operator delete(void *ptr, std::size_t /*size*/) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t /*size*/) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t & /*tag*/) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t & /*tag*/) noexcept
+{
+	devilution::TrackedFree(ptr);
+}
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file memory_stats.hpp
+ *
+ * Accounting of the heap memory used by each subsystem, enabled with the MEMORY_ACCOUNTING build option.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/enum_traits.h"
+
+namespace devilution {
+
+struct Surface;
+
+enum class MemoryCategory : uint8_t {
+	FIRST,
+	Other = FIRST,
+	Dungeon,
+	Monsters,
+	Players,
+	Missiles,
+	Items,
+	Sound,
+	Fonts,
+	Levels,
+
+	LAST = Levels
+};
+
+struct MemoryUsage {
+	size_t currentBytes;
+	size_t peakBytes;
+};
+
+extern bool ShowMemoryOverlay;
+
+/**
+ * @brief Attribute the allocations of the current thread to a category until the scope ends
+ *
+ * Memory is freed from the category it was allocated in, no matter which scope is active then.
+ */
+class MemoryCategoryScope {
+public:
+#ifdef MEMORY_ACCOUNTING
+	explicit MemoryCategoryScope(MemoryCategory category);
+	~MemoryCategoryScope();
+#else
+	explicit MemoryCategoryScope(MemoryCategory /*category*/)
+	{
+	}
+#endif
+
+	MemoryCategoryScope(const MemoryCategoryScope &) = delete;
+	MemoryCategoryScope &operator=(const MemoryCategoryScope &) = delete;
+
+#ifdef MEMORY_ACCOUNTING
+private:
+	MemoryCategory previous_;
+#endif
+};
+
+/**
+ * @brief Account for memory that isn't allocated with new, such as SDL surfaces
+ * @param bytes Positive when the memory is allocated, negative when it is freed
+ */
+void TrackExternalMemory(MemoryCategory category, std::ptrdiff_t bytes);
+
+MemoryUsage GetMemoryUsage(MemoryCategory category);
+const char *MemoryCategoryName(MemoryCategory category);
+
+/**
+ * @brief Log the current and peak usage of each category
+ */
+void LogMemoryUsage();
+
+/**
+ * @brief Show the current and peak usage of each category, if ShowMemoryOverlay is set
+ */
+void DrawMemoryOverlay(const Surface &out);
+
+} // namespace devilution
@@ -0,0 +1,211 @@
+#include "utils/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "engine/render/text_render.hpp"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace profiler {
+
+std::atomic<bool> Enabled { false };
+
+namespace {
+
+/** Zones kept per thread, older zones are overwritten */
+constexpr size_t RingSize = 1 << 16;
+constexpr uint64_t StatsWindowNs = 1000000000;
+
+struct ZoneRecord {
+	const char *name;
+	uint64_t startNs;
+	uint64_t endNs;
+};
+
+struct ThreadRing {
+	size_t threadIndex;
+	std::unique_ptr<ZoneRecord[]> records { new ZoneRecord[RingSize] };
+	/** Total number of zones recorded, only written by the owning thread */
+	std::atomic<uint64_t> written { 0 };
+	/** Set before a record is stored, so WriteTrace can tell which slots were overwritten while it copied them */
+	std::atomic<uint64_t> claimed { 0 };
+};
+
+struct ZoneStats {
+	const char *name;
+	uint64_t frameNs;
+	uint64_t windowTotalNs;
+	uint64_t windowMaxNs;
+	double averageMs;
+	double maxMs;
+};
+
+std::string TracePath;
+uint64_t StartNs;
+
+std::mutex RingsMutex;
+/** Rings are kept after their thread exits, so the trace includes them */
+std::vector<std::unique_ptr<ThreadRing>> Rings;
+thread_local ThreadRing *CurrentRing = nullptr;
+
+/** Zones of the thread calling FrameMark, in the order they first finished */
+std::vector<ZoneStats> FrameZones;
+uint64_t FrameMarkNs;
+uint64_t ProcessedZones;
+uint64_t WindowStartNs;
+uint64_t WindowFrameTotalNs;
+uint64_t WindowFrameMaxNs;
+int WindowFrames;
+double FrameAverageMs;
+double FrameMaxMs;
+
+ThreadRing &GetRing()
+{
+	if (CurrentRing == nullptr) {
+		std::lock_guard<std::mutex> lock(RingsMutex);
+		Rings.emplace_back(new ThreadRing());
+		CurrentRing = Rings.back().get();
+		CurrentRing->threadIndex = Rings.size();
+	}
+	return *CurrentRing;
+}
+
+ZoneStats &GetFrameZone(const char *name)
+{
+	for (ZoneStats &zone : FrameZones) {
+		if (zone.name == name || std::strcmp(zone.name, name) == 0)
+			return zone;
+	}
+	FrameZones.push_back({ name, 0, 0, 0, 0, 0 });
+	return FrameZones.back();
+}
+
+void PublishWindow(uint64_t now)
+{
+	for (ZoneStats &zone : FrameZones) {
+		zone.averageMs = zone.windowTotalNs / 1000000.0 / WindowFrames;
+		zone.maxMs = zone.windowMaxNs / 1000000.0;
+		zone.windowTotalNs = 0;
+		zone.windowMaxNs = 0;
+	}
+	FrameAverageMs = WindowFrameTotalNs / 1000000.0 / WindowFrames;
+	FrameMaxMs = WindowFrameMaxNs / 1000000.0;
+	WindowFrameTotalNs = 0;
+	WindowFrameMaxNs = 0;
+	WindowFrames = 0;
+	WindowStartNs = now;
+}
+
+void WriteTrace()
+{
+	std::ofstream file(TracePath, std::ios::out | std::ios::trunc);
+	file << "{\"traceEvents\":[";
+	bool first = true;
+	std::lock_guard<std::mutex> lock(RingsMutex);
+	std::vector<ZoneRecord> zones;
+	for (auto &ring : Rings) {
+		const uint64_t written = ring->written.load(std::memory_order_acquire);
+		uint64_t begin = written > RingSize ? written - RingSize : 0;
+		zones.assign(&ring->records[0], &ring->records[RingSize]);
+		// Zones that were already open when profiling stopped can still be recorded while copying,
+		// overwriting the oldest slots. Drop every slot the writer claimed since the snapshot.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+		if (claimed > RingSize)
+			begin = std::max(begin, claimed - RingSize);
+		for (uint64_t i = begin; i < written; i++) {
+			const ZoneRecord &zone = zones[i % RingSize];
+			file << fmt::format("{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+			    first ? "" : ",", zone.name, ring->threadIndex, (zone.startNs - StartNs) / 1000.0, (zone.endNs - zone.startNs) / 1000.0);
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+	if (!file)
+		LogError("Unable to write profiler trace to {}", TracePath);
+}
+
+} // namespace
+
+void Init(std::string tracePath)
+{
+	TracePath = std::move(tracePath);
+	StartNs = NowNs();
+	FrameMarkNs = StartNs;
+	WindowStartNs = StartNs;
+	Enabled.store(true, std::memory_order_relaxed);
+}
+
+void Shutdown()
+{
+	if (!Enabled.exchange(false, std::memory_order_relaxed))
+		return;
+	if (!TracePath.empty())
+		WriteTrace();
+}
+
+void RecordZone(const char *name, uint64_t startNs, uint64_t endNs)
+{
+	ThreadRing &ring = GetRing();
+	const uint64_t index = ring.written.load(std::memory_order_relaxed);
+	ring.claimed.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	ring.records[index % RingSize] = { name, startNs, endNs };
+	ring.written.store(index + 1, std::memory_order_release);
+}
+
+void FrameMark()
+{
+	if (!Enabled.load(std::memory_order_relaxed))
+		return;
+
+	const uint64_t now = NowNs();
+	ThreadRing &ring = GetRing();
+	const uint64_t written = ring.written.load(std::memory_order_relaxed);
+	for (uint64_t i = std::max(ProcessedZones, written > RingSize ? written - RingSize : 0); i < written; i++) {
+		const ZoneRecord &record = ring.records[i % RingSize];
+		GetFrameZone(record.name).frameNs += record.endNs - record.startNs;
+	}
+	ProcessedZones = written;
+
+	for (ZoneStats &zone : FrameZones) {
+		zone.windowTotalNs += zone.frameNs;
+		zone.windowMaxNs = std::max(zone.windowMaxNs, zone.frameNs);
+		zone.frameNs = 0;
+	}
+	const uint64_t frameNs = now - FrameMarkNs;
+	FrameMarkNs = now;
+	WindowFrameTotalNs += frameNs;
+	WindowFrameMaxNs = std::max(WindowFrameMaxNs, frameNs);
+	WindowFrames++;
+
+	if (now - WindowStartNs >= StatsWindowNs)
+		PublishWindow(now);
+}
+
+void DrawOverlay(const Surface &out)
+{
+	if (!Enabled.load(std::memory_order_relaxed))
+		return;
+
+	constexpr int LineHeight = 12;
+	Point position { 8, 88 };
+	DrawString(out, fmt::format("Frame {:.2f} ms, worst {:.2f} ms", FrameAverageMs, FrameMaxMs), position, UiFlags::ColorWhite);
+	for (const ZoneStats &zone : FrameZones) {
+		position.y += LineHeight;
+		DrawString(out, fmt::format("{} {:.2f} ms, worst {:.2f} ms", zone.name, zone.averageMs, zone.maxMs), position, UiFlags::ColorWhite);
+	}
+}
+
+} // namespace profiler
+
+} // namespace devilution
@@ -0,0 +1,84 @@
+/**
+ * @file profiler.hpp
+ *
+ * Lightweight profiler for scoped zones with an in-game overlay and Chrome trace export.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace devilution {
+
+struct Surface;
+
+namespace profiler {
+
+/** Set between Init and Shutdown, zones may be opened on any thread */
+extern std::atomic<bool> Enabled;
+
+/**
+ * @brief Start profiling, the trace is written to the given path on Shutdown
+ */
+void Init(std::string tracePath);
+/**
+ * @brief Write the Chrome trace of the recorded zones
+ */
+void Shutdown();
+
+inline uint64_t NowNs()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+/**
+ * @brief Store a finished zone in the ring buffer of the current thread
+ * @param name Must be a string literal, only the pointer is kept
+ */
+void RecordZone(const char *name, uint64_t startNs, uint64_t endNs);
+
+/**
+ * @brief Marks the end of a frame, updating the statistics shown by DrawOverlay
+ */
+void FrameMark();
+
+/**
+ * @brief Show the average and worst time of each zone over the last second
+ */
+void DrawOverlay(const Surface &out);
+
+class ScopedZone {
+public:
+	explicit ScopedZone(const char *name)
+	{
+		if (!Enabled.load(std::memory_order_relaxed))
+			return;
+		name_ = name;
+		start_ = NowNs();
+	}
+
+	~ScopedZone()
+	{
+		if (name_ != nullptr)
+			RecordZone(name_, start_, NowNs());
+	}
+
+	ScopedZone(const ScopedZone &) = delete;
+	ScopedZone &operator=(const ScopedZone &) = delete;
+
+private:
+	const char *name_ = nullptr;
+	uint64_t start_ = 0;
+};
+
+} // namespace profiler
+
+} // namespace devilution
+
+#define DVL_PROFILE_CONCAT_(a, b) a##b
+#define DVL_PROFILE_CONCAT(a, b) DVL_PROFILE_CONCAT_(a, b)
+/** Time the rest of the current scope as a zone with the given name */
+#define DVL_PROFILE_ZONE(name) ::devilution::profiler::ScopedZone DVL_PROFILE_CONCAT(profileZone, __LINE__)(name)
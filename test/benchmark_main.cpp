@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+
+#include "diablo.h"
+
+int main(int argc, char **argv)
+{
+	// The fixtures don't need the game data, skip the error dialogs for missing files.
+	devilution::gbQuietMode = true;
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "codec.h"
+#include "encrypt.h"
+
+using namespace devilution;
+
+namespace {
+
+/**
+ * @brief Data that compresses roughly like a save game: long runs of zeros mixed with noise
+ */
+std::vector<byte> MakeData(size_t size)
+{
+	std::vector<byte> data(size);
+	uint32_t state = 1;
+	for (size_t i = 0; i < size; i++) {
+		state = state * 22695477 + 1;
+		data[i] = static_cast<byte>((i / 64) % 4 == 0 ? (state >> 24) : 0);
+	}
+	return data;
+}
+
+void BM_CodecEncode(benchmark::State &state)
+{
+	const size_t size = state.range(0);
+	const std::vector<byte> plain = MakeData(size);
+	std::vector<byte> buffer(codec_get_encoded_len(size));
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), plain.data(), size);
+		codec_encode(buffer.data(), size, buffer.size(), "xrgyrkj1");
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_CodecEncode)->Arg(4096)->Arg(256 * 1024);
+
+void BM_CodecDecode(benchmark::State &state)
+{
+	const size_t size = state.range(0);
+	std::vector<byte> encoded = MakeData(size);
+	encoded.resize(codec_get_encoded_len(size));
+	codec_encode(encoded.data(), size, encoded.size(), "xrgyrkj1");
+	std::vector<byte> buffer(encoded.size());
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), encoded.data(), encoded.size());
+		benchmark::DoNotOptimize(codec_decode(buffer.data(), buffer.size(), "xrgyrkj1"));
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_CodecDecode)->Arg(4096)->Arg(256 * 1024);
+
+void BM_PkwareCompress(benchmark::State &state)
+{
+	const size_t size = state.range(0);
+	const std::vector<byte> plain = MakeData(size);
+	std::vector<byte> buffer(size);
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), plain.data(), size);
+		benchmark::DoNotOptimize(PkwareCompress(buffer.data(), size));
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_PkwareCompress)->Arg(512)->Arg(64 * 1024);
+
+void BM_PkwareDecompress(benchmark::State &state)
+{
+	const size_t size = state.range(0);
+	std::vector<byte> compressed = MakeData(size);
+	const uint32_t compressedSize = PkwareCompress(compressed.data(), size);
+	std::vector<byte> buffer(size);
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), compressed.data(), compressedSize);
+		PkwareDecompress(buffer.data(), compressedSize, size);
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_PkwareDecompress)->Arg(512)->Arg(64 * 1024);
+
+void BM_CompressBuffer(benchmark::State &state)
+{
+	const auto codec = static_cast<CompressionCodec>(state.range(0));
+	const size_t size = state.range(1);
+	const std::vector<byte> plain = MakeData(size);
+	std::vector<byte> buffer(size);
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), plain.data(), size);
+		benchmark::DoNotOptimize(CompressBuffer(codec, buffer.data(), size));
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_CompressBuffer)->ArgsProduct({ { static_cast<int>(CompressionCodec::Pkware), static_cast<int>(CompressionCodec::Zlib) }, { 512 } });
+
+} // namespace
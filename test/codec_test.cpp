@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include <gtest/gtest.h>
 
 #include "codec.h"
@@ -13,3 +15,28 @@ TEST(Codec, codec_get_encoded_len_eq)
 {
 	EXPECT_EQ(codec_get_encoded_len(128), 136);
 }
+
+TEST(Codec, codec_encode_known_answer)
+{
+	// Saves must stay readable across versions, so the output of the X-SHA-1 based codec may never change
+	const uint8_t expected[] = {
+		98, 106, 250, 62, 82, 199, 9, 165, 234, 129, 141, 218, 77, 78, 45, 5,
+		70, 32, 109, 166, 238, 254, 110, 138, 230, 75, 149, 41, 22, 117, 25, 78,
+		249, 242, 161, 153, 202, 84, 25, 50, 122, 114, 210, 6, 122, 223, 97, 221,
+		130, 233, 149, 242, 117, 102, 53, 237, 190, 216, 133, 190, 198, 198, 70, 146,
+		77, 84, 70, 2, 94, 56, 105, 155, 235, 63, 232, 214, 166, 217, 69, 92,
+		193, 12, 43, 100, 193, 192, 210, 182, 234, 180, 245, 23, 151, 75, 124, 66,
+		18, 101, 201, 192, 241, 59, 21, 33, 141, 147, 136, 215, 130, 219, 131, 106,
+		19, 192, 238, 219, 178, 194, 103, 117, 241, 59, 21, 33, 141, 147, 136, 215,
+		198, 185, 212, 173, 0, 36, 0, 0,
+	};
+	byte buf[136];
+	for (int i = 0; i < 100; i++)
+		buf[i] = static_cast<byte>(i * 7);
+	codec_encode(buf, 100, sizeof(buf), "xrgyrkj1");
+	EXPECT_EQ(memcmp(buf, expected, sizeof(expected)), 0);
+
+	EXPECT_EQ(codec_decode(buf, sizeof(buf), "xrgyrkj1"), 100);
+	for (int i = 0; i < 100; i++)
+		EXPECT_EQ(buf[i], static_cast<byte>(i * 7));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "encrypt.h"
+
+using namespace devilution;
+
+namespace {
+
+/** Leaves room for the decompressed data in the same buffer */
+constexpr int Capacity = 8192;
+
+/**
+ * @brief Data that compresses roughly like a level delta: long runs of 0xFF mixed with noise
+ */
+std::vector<byte> MakeData(size_t size)
+{
+	std::vector<byte> data(size);
+	uint32_t state = 1;
+	for (size_t i = 0; i < size; i++) {
+		state = state * 22695477 + 1;
+		data[i] = static_cast<byte>((i / 32) % 4 == 0 ? (state >> 24) : 0xFF);
+	}
+	return data;
+}
+
+std::vector<byte> Compress(CompressionCodec codec, const std::vector<byte> &plain)
+{
+	std::vector<byte> buffer = plain;
+	buffer.resize(Capacity);
+	buffer.resize(CompressBuffer(codec, buffer.data(), static_cast<uint32_t>(plain.size())));
+	return buffer;
+}
+
+void TestRoundTrip(CompressionCodec codec)
+{
+	const std::vector<byte> plain = MakeData(4096);
+	std::vector<byte> buffer = Compress(codec, plain);
+	ASSERT_LT(buffer.size(), plain.size());
+
+	const int compressedSize = static_cast<int>(buffer.size());
+	buffer.resize(Capacity);
+	ASSERT_TRUE(DecompressBuffer(codec, buffer.data(), compressedSize, Capacity));
+	buffer.resize(plain.size());
+	EXPECT_EQ(buffer, plain);
+}
+
+} // namespace
+
+TEST(Compression, PkwareRoundTrip)
+{
+	TestRoundTrip(CompressionCodec::Pkware);
+}
+
+TEST(Compression, ZlibRoundTrip)
+{
+	TestRoundTrip(CompressionCodec::Zlib);
+}
+
+TEST(Compression, NoneLeavesDataAlone)
+{
+	const std::vector<byte> plain = MakeData(256);
+	std::vector<byte> buffer = plain;
+	EXPECT_EQ(CompressBuffer(CompressionCodec::None, buffer.data(), 256), 256);
+	EXPECT_TRUE(DecompressBuffer(CompressionCodec::None, buffer.data(), 256, 256));
+	EXPECT_EQ(buffer, plain);
+}
+
+TEST(Compression, RejectsUnknownCodec)
+{
+	std::vector<byte> buffer = MakeData(256);
+	EXPECT_FALSE(DecompressBuffer(static_cast<CompressionCodec>(3), buffer.data(), 256, 256));
+}
+
+TEST(Compression, RejectsZlibDataAsPkware)
+{
+	std::vector<byte> buffer = Compress(CompressionCodec::Zlib, MakeData(4096));
+	const int compressedSize = static_cast<int>(buffer.size());
+	buffer.resize(Capacity);
+	EXPECT_FALSE(DecompressBuffer(CompressionCodec::Pkware, buffer.data(), compressedSize, Capacity));
+}
+
+TEST(Compression, RejectsTruncatedZlibData)
+{
+	std::vector<byte> buffer = Compress(CompressionCodec::Zlib, MakeData(4096));
+	const int compressedSize = static_cast<int>(buffer.size()) / 2;
+	buffer.resize(Capacity);
+	EXPECT_FALSE(DecompressBuffer(CompressionCodec::Zlib, buffer.data(), compressedSize, Capacity));
+}
+
+TEST(Compression, RejectsOutputLargerThanBuffer)
+{
+	for (auto codec : { CompressionCodec::Pkware, CompressionCodec::Zlib }) {
+		std::vector<byte> buffer = Compress(codec, MakeData(4096));
+		const int compressedSize = static_cast<int>(buffer.size());
+		buffer.resize(Capacity);
+		EXPECT_FALSE(DecompressBuffer(codec, buffer.data(), compressedSize, 1024)) << static_cast<int>(codec);
+	}
+}
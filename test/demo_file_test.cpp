@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "engine/demo_file.hpp"
+
+using namespace devilution;
+
+namespace {
+
+std::string GetTmpPathName()
+{
+	const auto *current_test = ::testing::UnitTest::GetInstance()->current_test_info();
+	std::string result = "Test_";
+	result.append(current_test->test_case_name());
+	result += '_';
+	result.append(current_test->name());
+	result.append(".dmo");
+	return result;
+}
+
+void ExpectMessage(DemoReader &reader, const DemoMessage &expected)
+{
+	DemoMessage msg;
+	ASSERT_TRUE(reader.Peek(msg));
+	reader.Pop();
+	EXPECT_EQ(msg.type, expected.type);
+	EXPECT_EQ(msg.message, expected.message);
+	EXPECT_EQ(msg.wParam, expected.wParam);
+	EXPECT_EQ(msg.lParam, expected.lParam);
+	EXPECT_EQ(msg.progressToNextGameTick, expected.progressToNextGameTick);
+}
+
+} // namespace
+
+TEST(DemoFile, RoundTrip)
+{
+	const std::string path = GetTmpPathName();
+	std::vector<DemoMessage> messages;
+	// Enough records to need several reads of the window
+	for (int i = 0; i < 50000; i++) {
+		messages.push_back({ DemoMsgType::Rendering, 0, 0, 0, (i % 7) / 7.F });
+		messages.push_back({ DemoMsgType::Rendering, 0, 0, 0, (i % 7) / 7.F });
+		messages.push_back({ DemoMsgType::Message, 0x200, i % 3, (i * 37) << 16 | (i * 13 & 0xFFFF), 0.5F });
+		messages.push_back({ DemoMsgType::Message, 0x100, -5, -i, 0.5F });
+		messages.push_back({ DemoMsgType::GameTick, 0, 0, 0, 1 });
+	}
+	{
+		DemoWriter writer;
+		ASSERT_TRUE(writer.Open(path, { 3, 640, 480 }));
+		for (const DemoMessage &msg : messages)
+			writer.Write(msg);
+	}
+
+	DemoReader reader;
+	DemoHeader header;
+	ASSERT_TRUE(reader.Open(path, header));
+	EXPECT_EQ(header.saveNumber, 3);
+	EXPECT_EQ(header.width, 640);
+	EXPECT_EQ(header.height, 480);
+	for (const DemoMessage &msg : messages)
+		ExpectMessage(reader, msg);
+	DemoMessage msg;
+	EXPECT_FALSE(reader.Peek(msg));
+	reader.Close();
+	std::remove(path.c_str());
+}
+
+TEST(DemoFile, PeekDoesNotConsume)
+{
+	const std::string path = GetTmpPathName();
+	{
+		DemoWriter writer;
+		ASSERT_TRUE(writer.Open(path, { 0, 640, 480 }));
+		writer.Write({ DemoMsgType::GameTick, 0, 0, 0, 0 });
+		writer.Write({ DemoMsgType::Rendering, 0, 0, 0, 0.25F });
+	}
+
+	DemoReader reader;
+	DemoHeader header;
+	ASSERT_TRUE(reader.Open(path, header));
+	DemoMessage msg;
+	ASSERT_TRUE(reader.Peek(msg));
+	ExpectMessage(reader, { DemoMsgType::GameTick, 0, 0, 0, 0 });
+	ExpectMessage(reader, { DemoMsgType::Rendering, 0, 0, 0, 0.25F });
+	EXPECT_FALSE(reader.Peek(msg));
+	reader.Close();
+	std::remove(path.c_str());
+}
+
+TEST(DemoFile, StoresStateHashes)
+{
+	const std::string path = GetTmpPathName();
+	DemoMessage hashes { DemoMsgType::StateHash, 0, 0, 0, 1 };
+	for (size_t i = 0; i < hashes.hashes.size(); i++)
+		hashes.hashes[i] = 0xDEADBEEF ^ static_cast<uint32_t>(i);
+	{
+		DemoWriter writer;
+		ASSERT_TRUE(writer.Open(path, { 0, 640, 480 }));
+		writer.Write({ DemoMsgType::GameTick, 0, 0, 0, 1 });
+		writer.Write(hashes);
+		writer.Write({ DemoMsgType::Message, 0x200, 1, 2, 1 });
+	}
+
+	DemoReader reader;
+	DemoHeader header;
+	ASSERT_TRUE(reader.Open(path, header));
+	ExpectMessage(reader, { DemoMsgType::GameTick, 0, 0, 0, 1 });
+	DemoMessage msg;
+	ASSERT_TRUE(reader.Peek(msg));
+	reader.Pop();
+	EXPECT_EQ(msg.type, DemoMsgType::StateHash);
+	EXPECT_EQ(msg.hashes, hashes.hashes);
+	ExpectMessage(reader, { DemoMsgType::Message, 0x200, 1, 2, 1 });
+	EXPECT_FALSE(reader.Peek(msg));
+	reader.Close();
+	std::remove(path.c_str());
+}
+
+TEST(DemoFile, ImportsTextDemos)
+{
+	const std::string path = GetTmpPathName();
+	{
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		file << "0,2,800,600\n"
+		     << "0,0\n"
+		     << "1,0.6\n"
+		     << "2,0.6,513,1,-4063172\n"
+		     << "0,1\n";
+	}
+
+	DemoReader reader;
+	DemoHeader header;
+	ASSERT_TRUE(reader.Open(path, header));
+	EXPECT_EQ(header.saveNumber, 2);
+	EXPECT_EQ(header.width, 800);
+	EXPECT_EQ(header.height, 600);
+	ExpectMessage(reader, { DemoMsgType::GameTick, 0, 0, 0, 0 });
+	ExpectMessage(reader, { DemoMsgType::Rendering, 0, 0, 0, 0.6F });
+	ExpectMessage(reader, { DemoMsgType::Message, 513, 1, -4063172, 0.6F });
+	ExpectMessage(reader, { DemoMsgType::GameTick, 0, 0, 0, 1 });
+	DemoMessage msg;
+	EXPECT_FALSE(reader.Peek(msg));
+	reader.Close();
+	std::remove(path.c_str());
+}
+
+TEST(DemoFile, RejectsUnknownTextVersion)
+{
+	const std::string path = GetTmpPathName();
+	{
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		file << "1,2,800,600\n";
+	}
+
+	DemoReader reader;
+	DemoHeader header;
+	EXPECT_FALSE(reader.Open(path, header));
+	reader.Close();
+	std::remove(path.c_str());
+}
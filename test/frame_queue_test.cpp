@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "dvlnet/frame_queue.h"
+
+using namespace devilution::net;
+
+namespace {
+
+buffer_t MakePacket(size_t size, unsigned char fill)
+{
+	return buffer_t(size, fill);
+}
+
+} // namespace
+
+TEST(FrameQueue, ReadsWholeFrame)
+{
+	frame_queue queue;
+	buffer_t packet = MakePacket(10, 0xAB);
+	queue.Write(frame_queue::MakeFrame(packet));
+
+	ASSERT_TRUE(queue.PacketReady());
+	EXPECT_EQ(queue.ReadPacket(), packet);
+	EXPECT_FALSE(queue.PacketReady());
+}
+
+TEST(FrameQueue, ReassemblesSplitFrames)
+{
+	frame_queue queue;
+	buffer_t first = MakePacket(7, 1);
+	buffer_t second = MakePacket(300, 2);
+	buffer_t stream = frame_queue::MakeFrame(first);
+	buffer_t secondFrame = frame_queue::MakeFrame(second);
+	stream.insert(stream.end(), secondFrame.begin(), secondFrame.end());
+
+	// Deliver the stream one byte at a time, including the size headers
+	std::vector<buffer_t> packets;
+	for (unsigned char byte : stream) {
+		queue.Write(buffer_t { byte });
+		while (queue.PacketReady())
+			packets.push_back(queue.ReadPacket());
+	}
+
+	ASSERT_EQ(packets.size(), 2);
+	EXPECT_EQ(packets[0], first);
+	EXPECT_EQ(packets[1], second);
+}
+
+TEST(FrameQueue, ReceivesInPlace)
+{
+	frame_queue queue;
+	buffer_t packet = MakePacket(frame_queue::max_frame_size, 3);
+	buffer_t frame = frame_queue::MakeFrame(packet);
+
+	// Simulate a socket that fills the prepared buffer in two partial reads
+	size_t half = frame.size() / 2;
+	std::memcpy(queue.Prepare(frame_queue::max_frame_size), frame.data(), half);
+	queue.Commit(half);
+	EXPECT_FALSE(queue.PacketReady());
+	std::memcpy(queue.Prepare(frame_queue::max_frame_size), frame.data() + half, frame.size() - half);
+	queue.Commit(frame.size() - half);
+
+	ASSERT_TRUE(queue.PacketReady());
+	EXPECT_EQ(queue.ReadPacket(), packet);
+}
+
+TEST(FrameQueue, RejectsEmptyFrame)
+{
+	frame_queue queue;
+	queue.Write(buffer_t(sizeof(framesize_t), 0));
+	EXPECT_THROW(queue.PacketReady(), frame_queue_exception);
+}
@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "gendung.h"
+#include "lighting.h"
+
+using namespace devilution;
+
+namespace {
+
+void BM_DoLighting(benchmark::State &state)
+{
+	const int radius = state.range(0);
+	MakeLightTable();
+	memset(dLight, 15, sizeof(dLight));
+	for (auto _ : state) {
+		DoLighting({ MAXDUNX / 2, MAXDUNY / 2 }, radius, -1);
+		benchmark::DoNotOptimize(dLight);
+	}
+}
+BENCHMARK(BM_DoLighting)->Arg(2)->Arg(10)->Arg(15);
+
+} // namespace
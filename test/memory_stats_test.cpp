@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "utils/memory_stats.hpp"
+
+using namespace devilution;
+
+TEST(MemoryStats, CategoryNames)
+{
+	EXPECT_STREQ(MemoryCategoryName(MemoryCategory::Other), "Other");
+	EXPECT_STREQ(MemoryCategoryName(MemoryCategory::Monsters), "Monsters");
+	EXPECT_STREQ(MemoryCategoryName(MemoryCategory::Levels), "Levels");
+}
+
+TEST(MemoryStats, ScopeAttributesAllocations)
+{
+#ifndef MEMORY_ACCOUNTING
+	GTEST_SKIP() << "Built without MEMORY_ACCOUNTING";
+#else
+	const MemoryUsage before = GetMemoryUsage(MemoryCategory::Missiles);
+	std::unique_ptr<char[]> block;
+	{
+		MemoryCategoryScope memoryScope(MemoryCategory::Missiles);
+		block.reset(new char[4096]);
+	}
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Missiles).currentBytes, before.currentBytes + 4096);
+	EXPECT_GE(GetMemoryUsage(MemoryCategory::Missiles).peakBytes, before.currentBytes + 4096);
+
+	// Freed from the category it was allocated in, even outside of the scope
+	block = nullptr;
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Missiles).currentBytes, before.currentBytes);
+	EXPECT_GE(GetMemoryUsage(MemoryCategory::Missiles).peakBytes, before.currentBytes + 4096);
+#endif
+}
+
+TEST(MemoryStats, ScopesNest)
+{
+#ifndef MEMORY_ACCOUNTING
+	GTEST_SKIP() << "Built without MEMORY_ACCOUNTING";
+#else
+	const size_t soundBefore = GetMemoryUsage(MemoryCategory::Sound).currentBytes;
+	const size_t itemsBefore = GetMemoryUsage(MemoryCategory::Items).currentBytes;
+	MemoryCategoryScope outerScope(MemoryCategory::Sound);
+	std::unique_ptr<char[]> inner;
+	{
+		MemoryCategoryScope innerScope(MemoryCategory::Items);
+		inner.reset(new char[100]);
+	}
+	std::unique_ptr<char[]> outer { new char[200] };
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Items).currentBytes, itemsBefore + 100);
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Sound).currentBytes, soundBefore + 200);
+#endif
+}
+
+TEST(MemoryStats, ExternalMemory)
+{
+#ifndef MEMORY_ACCOUNTING
+	GTEST_SKIP() << "Built without MEMORY_ACCOUNTING";
+#else
+	const size_t before = GetMemoryUsage(MemoryCategory::Fonts).currentBytes;
+	TrackExternalMemory(MemoryCategory::Fonts, 1000);
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Fonts).currentBytes, before + 1000);
+	TrackExternalMemory(MemoryCategory::Fonts, -1000);
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Fonts).currentBytes, before);
+#endif
+}
+
+TEST(MemoryStats, HugeAllocationFails)
+{
+#ifndef MEMORY_ACCOUNTING
+	GTEST_SKIP() << "Built without MEMORY_ACCOUNTING";
+#else
+	const size_t before = GetMemoryUsage(MemoryCategory::Other).currentBytes;
+	// Would wrap around when the allocation header is added
+	void *block = ::operator new(SIZE_MAX - 8, std::nothrow);
+	EXPECT_EQ(block, nullptr);
+	EXPECT_EQ(GetMemoryUsage(MemoryCategory::Other).currentBytes, before);
+#endif
+}
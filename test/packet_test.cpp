@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dvlnet/packet.h"
+
+using namespace devilution::net;
+
+namespace {
+
+constexpr plr_t Source = 1;
+constexpr plr_t Destination = PLR_BROADCAST;
+
+std::unique_ptr<packet> MakeBundle(packet_factory &factory, const buffer_t &payload)
+{
+	auto bundle = factory.make_packet<PT_BUNDLE>(Source, Destination, payload);
+	// Parse the serialized bundle like a receiving client does
+	return factory.make_packet(bundle->Data());
+}
+
+std::vector<packet_type> ParseBundle(packet_factory &factory, const buffer_t &payload)
+{
+	std::vector<packet_type> types;
+	auto bundle = MakeBundle(factory, payload);
+	factory.for_each_bundled(*bundle, [&](packet &pkt) { types.push_back(pkt.Type()); });
+	return types;
+}
+
+} // namespace
+
+TEST(PacketBundle, RoundTrip)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_MESSAGE>(Source, Destination, buffer_t { 1, 2, 3 })->Data());
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_TURN>(Source, Destination, turn_t { 42 })->Data());
+
+	auto bundle = MakeBundle(factory, payload);
+	std::vector<buffer_t> messages;
+	std::vector<turn_t> turns;
+	factory.for_each_bundled(*bundle, [&](packet &pkt) {
+		EXPECT_EQ(pkt.Source(), Source);
+		EXPECT_EQ(pkt.Destination(), Destination);
+		if (pkt.Type() == PT_MESSAGE)
+			messages.push_back(pkt.Message());
+		else
+			turns.push_back(pkt.Turn());
+	});
+
+	ASSERT_EQ(messages.size(), 1);
+	EXPECT_EQ(messages[0], (buffer_t { 1, 2, 3 }));
+	ASSERT_EQ(turns.size(), 1);
+	EXPECT_EQ(turns[0], 42);
+	EXPECT_EQ(packet_factory::count_bundled(bundle->Bundle(), PT_TURN), 1);
+	EXPECT_EQ(packet_factory::count_bundled(bundle->Bundle(), PT_MESSAGE), 1);
+}
+
+TEST(PacketBundle, EmptyBundle)
+{
+	packet_factory factory;
+	EXPECT_TRUE(ParseBundle(factory, {}).empty());
+	EXPECT_EQ(packet_factory::count_bundled({}, PT_TURN), 0);
+}
+
+TEST(PacketBundle, RejectsTruncatedLengthPrefix)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_TURN>(Source, Destination, turn_t { 1 })->Data());
+	payload.push_back(0x05);
+
+	EXPECT_THROW(ParseBundle(factory, payload), packet_exception);
+	EXPECT_EQ(packet_factory::count_bundled(payload, PT_TURN), 1);
+}
+
+TEST(PacketBundle, RejectsTruncatedPacket)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_TURN>(Source, Destination, turn_t { 1 })->Data());
+	payload.pop_back();
+
+	EXPECT_THROW(ParseBundle(factory, payload), packet_exception);
+	EXPECT_EQ(packet_factory::count_bundled(payload, PT_TURN), 0);
+}
+
+TEST(PacketBundle, RejectsMismatchedSource)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_TURN>(plr_t { 2 }, Destination, turn_t { 1 })->Data());
+
+	EXPECT_THROW(ParseBundle(factory, payload), packet_exception);
+}
+
+TEST(PacketBundle, RejectsMismatchedDestination)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_MESSAGE>(Source, plr_t { 0 }, buffer_t { 1 })->Data());
+
+	EXPECT_THROW(ParseBundle(factory, payload), packet_exception);
+}
+
+TEST(PacketBundle, RejectsNestedBundle)
+{
+	packet_factory factory;
+	buffer_t inner;
+	packet_factory::append_bundled(inner, factory.make_plain_packet<PT_TURN>(Source, Destination, turn_t { 1 })->Data());
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_BUNDLE>(Source, Destination, inner)->Data());
+
+	EXPECT_THROW(ParseBundle(factory, payload), wrong_packet_type_exception);
+}
+
+TEST(PacketBundle, RejectsControlPackets)
+{
+	packet_factory factory;
+	buffer_t payload;
+	packet_factory::append_bundled(payload, factory.make_plain_packet<PT_DISCONNECT>(Source, Destination, plr_t { 2 }, leaveinfo_t { 0 })->Data());
+
+	EXPECT_THROW(ParseBundle(factory, payload), wrong_packet_type_exception);
+}
@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+
+#include "palette.h"
+
+using namespace devilution;
+
+namespace {
+
+void BM_GenerateBlendedLookupTable(benchmark::State &state)
+{
+	SDL_Color palette[256];
+	for (int i = 0; i < 256; i++) {
+		// 16 hues with 16 shades each, like the level palettes
+		const int shade = 255 - (i % 16) * 16;
+		palette[i].r = static_cast<Uint8>(((i / 16) & 1) != 0 ? shade : shade / 2);
+		palette[i].g = static_cast<Uint8>(((i / 16) & 2) != 0 ? shade : shade / 3);
+		palette[i].b = static_cast<Uint8>(((i / 16) & 4) != 0 ? shade : shade / 4);
+	}
+	for (auto _ : state) {
+		GenerateBlendedLookupTable(palette, -1, -1);
+		benchmark::DoNotOptimize(paletteTransparencyLookup);
+	}
+}
+BENCHMARK(BM_GenerateBlendedLookupTable)->Unit(benchmark::kMillisecond);
+
+} // namespace
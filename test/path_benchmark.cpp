@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include "path.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int MapSize = 40;
+
+/**
+ * @brief Open field with walls that force detours, each wall has a gap at alternating ends
+ */
+std::array<std::array<bool, MapSize>, MapSize> MakeWalls(bool walls)
+{
+	std::array<std::array<bool, MapSize>, MapSize> solid {};
+	if (!walls)
+		return solid;
+	for (int x = 8; x < MapSize; x += 6) {
+		const bool gapAtTop = (x / 6) % 2 == 0;
+		for (int y = 0; y < MapSize; y++)
+			solid[x][y] = gapAtTop ? y > 2 : y < MapSize - 3;
+	}
+	return solid;
+}
+
+void BM_FindPath(benchmark::State &state)
+{
+	const auto solid = MakeWalls(state.range(0) != 0);
+	const auto posOk = [&solid](Point position) {
+		return position.x >= 0 && position.y >= 0 && position.x < MapSize && position.y < MapSize && !solid[position.x][position.y];
+	};
+	const Point start { 5, 20 };
+	const Point destination { 5 + static_cast<int>(state.range(1)), 20 };
+	int8_t path[MAX_PATH_LENGTH];
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(FindPath(posOk, start, destination, path));
+	}
+}
+BENCHMARK(BM_FindPath)->ArgsProduct({ { 0, 1 }, { 8, 20 } })->ArgNames({ "walls", "distance" });
+
+} // namespace
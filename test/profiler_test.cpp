@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "utils/profiler.hpp"
+
+using namespace devilution;
+
+namespace {
+
+std::string ReadFile(const std::string &path)
+{
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+} // namespace
+
+TEST(Profiler, DisabledZonesAreNotRecorded)
+{
+	const std::string path = "Test_Profiler_Disabled.json";
+	{
+		DVL_PROFILE_ZONE("BeforeInit");
+	}
+	profiler::Init(path);
+	profiler::Shutdown();
+	EXPECT_EQ(ReadFile(path).find("BeforeInit"), std::string::npos);
+	std::remove(path.c_str());
+}
+
+TEST(Profiler, WritesChromeTrace)
+{
+	const std::string path = "Test_Profiler_Trace.json";
+	profiler::Init(path);
+	{
+		DVL_PROFILE_ZONE("Outer");
+		DVL_PROFILE_ZONE("Inner");
+	}
+	std::thread worker([]() {
+		DVL_PROFILE_ZONE("Worker");
+	});
+	worker.join();
+	profiler::FrameMark();
+	profiler::Shutdown();
+	EXPECT_FALSE(profiler::Enabled);
+
+	const std::string trace = ReadFile(path);
+	EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0U);
+	EXPECT_NE(trace.find("\"name\":\"Outer\",\"ph\":\"X\""), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"Inner\",\"ph\":\"X\""), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"Worker\",\"ph\":\"X\""), std::string::npos);
+	std::remove(path.c_str());
+}
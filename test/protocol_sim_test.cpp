@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "dvlnet/protocol_sim.h"
+
+using namespace devilution::net;
+
+namespace {
+
+buffer_t MakePacket(size_t size, unsigned char fill)
+{
+	return buffer_t(size, fill);
+}
+
+} // namespace
+
+TEST(ProtocolSim, DeliversAfterLatency)
+{
+	sim_network network(true);
+	sim_conditions conditions;
+	conditions.latency_ms = 30;
+	network.SetConditions(conditions);
+	protocol_sim a(network);
+	protocol_sim b(network);
+	protocol_sim::endpoint peer;
+	buffer_t data;
+
+	// b learns a's endpoint from the first packet, like from an info reply
+	a.send_oob_mc(MakePacket(5, 1));
+	EXPECT_FALSE(b.recv(peer, data));
+	network.Advance(29);
+	EXPECT_FALSE(b.recv(peer, data));
+	network.Advance(1);
+	ASSERT_TRUE(b.recv(peer, data));
+	EXPECT_EQ(data, MakePacket(5, 1));
+
+	b.send(peer, MakePacket(3, 2));
+	network.Advance(30);
+	ASSERT_TRUE(a.recv(peer, data));
+	EXPECT_EQ(data, MakePacket(3, 2));
+	EXPECT_FALSE(a.recv(peer, data));
+}
+
+TEST(ProtocolSim, StreamsStayInOrder)
+{
+	sim_network network(true);
+	sim_conditions conditions;
+	conditions.latency_ms = 10;
+	conditions.jitter_ms = 50;
+	conditions.reorder = 0.5F;
+	conditions.loss = 0.2F;
+	network.SetConditions(conditions);
+	protocol_sim a(network);
+	protocol_sim b(network);
+	protocol_sim::endpoint peer;
+	buffer_t data;
+	a.send_oob_mc(MakePacket(1, 0));
+	network.Advance(1000);
+	ASSERT_TRUE(b.recv(peer, data));
+
+	for (unsigned char i = 0; i < 100; i++)
+		b.send(peer, MakePacket(1, i));
+	network.Advance(60000);
+	for (unsigned char i = 0; i < 100; i++) {
+		ASSERT_TRUE(a.recv(peer, data));
+		EXPECT_EQ(data, MakePacket(1, i));
+	}
+	EXPECT_FALSE(a.recv(peer, data));
+	EXPECT_GT(network.Stats().packets_lost, 0);
+}
+
+TEST(ProtocolSim, DropsLostDatagrams)
+{
+	sim_network network(true);
+	sim_conditions conditions;
+	conditions.loss = 1;
+	network.SetConditions(conditions);
+	protocol_sim a(network);
+	protocol_sim b(network);
+	protocol_sim::endpoint peer;
+	buffer_t data;
+
+	a.send_oob_mc(MakePacket(8, 1));
+	network.Advance(1000);
+	EXPECT_FALSE(b.recv(peer, data));
+	EXPECT_EQ(network.Stats().packets_lost, 1);
+}
+
+TEST(ProtocolSim, LimitsBandwidth)
+{
+	sim_network network(true);
+	sim_conditions conditions;
+	conditions.bandwidth = 1000;
+	network.SetConditions(conditions);
+	protocol_sim a(network);
+	protocol_sim b(network);
+	protocol_sim::endpoint peer;
+	buffer_t data;
+
+	// Each packet takes 100ms to upload, the second one waits for the first
+	a.send_oob_mc(MakePacket(100, 1));
+	a.send_oob_mc(MakePacket(100, 2));
+	network.Advance(99);
+	EXPECT_FALSE(b.recv(peer, data));
+	network.Advance(1);
+	ASSERT_TRUE(b.recv(peer, data));
+	EXPECT_EQ(data, MakePacket(100, 1));
+	EXPECT_FALSE(b.recv(peer, data));
+	network.Advance(100);
+	ASSERT_TRUE(b.recv(peer, data));
+	EXPECT_EQ(data, MakePacket(100, 2));
+}
+
+TEST(ProtocolSim, ReportsDisconnectedPeers)
+{
+	sim_network network(true);
+	protocol_sim a(network);
+	protocol_sim::endpoint peer;
+	buffer_t data;
+	{
+		protocol_sim b(network);
+		a.send_oob_mc(MakePacket(1, 1));
+		ASSERT_TRUE(b.recv(peer, data));
+		b.send(peer, MakePacket(1, 2));
+		ASSERT_TRUE(a.recv(peer, data));
+	}
+	protocol_sim::endpoint disconnected;
+	ASSERT_TRUE(a.get_disconnected(disconnected));
+	EXPECT_EQ(disconnected, peer);
+	EXPECT_FALSE(a.get_disconnected(disconnected));
+}
+
+TEST(ProtocolSim, SerializesEndpoints)
+{
+	protocol_sim::endpoint endpoint;
+	endpoint.id = 0x12345678;
+	protocol_sim::endpoint copy;
+	copy.unserialize(endpoint.serialize());
+	EXPECT_EQ(copy, endpoint);
+}
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "engine/cel_sprite.hpp"
+#include "engine/render/cel_render.hpp"
+#include "engine/render/cl2_render.hpp"
+#include "engine/render/dun_render.hpp"
+#include "engine/render/text_render.hpp"
+#include "engine/surface.hpp"
+#include "gendung.h"
+#include "lighting.h"
+#include "scrollrt.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int SpriteWidth = 96;
+constexpr int SpriteHeight = 128;
+
+/** Tile types as encoded in bits 12-14 of level_cel_block */
+enum TileType : uint8_t {
+	Square,
+	TransparentSquare,
+	LeftTriangle,
+	RightTriangle,
+	LeftTrapezoid,
+	RightTrapezoid,
+};
+
+void AppendLE32(std::vector<uint8_t> &data, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+/**
+ * @brief Wrap frames in the CEL/CL2 container: the frame count followed by the frame offsets
+ */
+std::unique_ptr<byte[]> MakeSpriteFile(const std::vector<std::vector<uint8_t>> &frames)
+{
+	std::vector<uint8_t> file;
+	AppendLE32(file, static_cast<uint32_t>(frames.size()));
+	uint32_t offset = static_cast<uint32_t>(4 * (frames.size() + 2));
+	for (const auto &frame : frames) {
+		AppendLE32(file, offset);
+		offset += static_cast<uint32_t>(frame.size());
+	}
+	AppendLE32(file, offset);
+	for (const auto &frame : frames)
+		file.insert(file.end(), frame.begin(), frame.end());
+
+	std::unique_ptr<byte[]> data { new byte[file.size()] };
+	std::memcpy(data.get(), file.data(), file.size());
+	return data;
+}
+
+/**
+ * @brief Each row is a transparent run, 64 pixels and another transparent run
+ */
+std::vector<uint8_t> MakeCelFrame()
+{
+	std::vector<uint8_t> frame;
+	for (int y = 0; y < SpriteHeight; y++) {
+		frame.push_back(static_cast<uint8_t>(-16));
+		frame.push_back(64);
+		for (int x = 0; x < 64; x++)
+			frame.push_back(static_cast<uint8_t>(x + y));
+		frame.push_back(static_cast<uint8_t>(-16));
+	}
+	return frame;
+}
+
+/**
+ * @brief Each row is a transparent run, a 32 pixel fill and 48 pixels
+ */
+std::vector<uint8_t> MakeCl2Frame()
+{
+	std::vector<uint8_t> frame(10, 0);
+	frame[0] = 10; // Pixel data follows the header of 5 row offsets
+	for (int y = 0; y < SpriteHeight; y++) {
+		frame.push_back(16);
+		frame.push_back(0xBF - 32);
+		frame.push_back(static_cast<uint8_t>(y));
+		frame.push_back(static_cast<uint8_t>(-48));
+		for (int x = 0; x < 48; x++)
+			frame.push_back(static_cast<uint8_t>(x + y));
+	}
+	return frame;
+}
+
+std::vector<uint8_t> MakeTileFrame(TileType type)
+{
+	std::vector<uint8_t> frame;
+	if (type == TransparentSquare) {
+		for (int y = 0; y < 32; y++) {
+			frame.push_back(16);
+			for (int x = 0; x < 16; x++)
+				frame.push_back(static_cast<uint8_t>(x + y));
+			frame.push_back(static_cast<uint8_t>(-8));
+			frame.push_back(8);
+			for (int x = 0; x < 8; x++)
+				frame.push_back(static_cast<uint8_t>(x + y));
+		}
+		return frame;
+	}
+	// The other types are raw pixels, the triangles and trapezoids use less than a square
+	for (int i = 0; i < 32 * 32; i++)
+		frame.push_back(static_cast<uint8_t>(i * 7));
+	return frame;
+}
+
+void SetUpLighting(int lightTableIndex)
+{
+	LightsMax = 15;
+	MakeLightTable();
+	LightTableIndex = lightTableIndex;
+}
+
+void BM_RenderTile(benchmark::State &state)
+{
+	const auto type = static_cast<TileType>(state.range(0));
+	SetUpLighting(state.range(1));
+	std::vector<std::vector<uint8_t>> frames;
+	for (int i = Square; i <= RightTrapezoid; i++)
+		frames.push_back(MakeTileFrame(static_cast<TileType>(i)));
+	pDungeonCels = MakeSpriteFile(frames);
+	level_cel_block = (type << 12) | (type + 1);
+	arch_draw_type = 0;
+	cel_transparency_active = false;
+	cel_foliage_active = false;
+
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state) {
+		RenderTile(out, { 304, 240 });
+		benchmark::ClobberMemory();
+	}
+	pDungeonCels = nullptr;
+}
+BENCHMARK(BM_RenderTile)
+    ->ArgsProduct({ { Square, TransparentSquare, LeftTriangle, RightTriangle, LeftTrapezoid, RightTrapezoid }, { 0, 7 } })
+    ->ArgNames({ "type", "light" });
+
+void BM_CelDrawLightTo(benchmark::State &state)
+{
+	SetUpLighting(7);
+	const CelSprite cel { MakeSpriteFile({ MakeCelFrame() }), SpriteWidth };
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state) {
+		CelDrawLightTo(out, { 272, 300 }, cel, 1, nullptr);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+BENCHMARK(BM_CelDrawLightTo);
+
+void BM_Cl2Draw(benchmark::State &state)
+{
+	const CelSprite cl2 { MakeSpriteFile({ MakeCl2Frame() }), SpriteWidth };
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state) {
+		Cl2Draw(out, 272, 300, cl2, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+BENCHMARK(BM_Cl2Draw);
+
+void BM_Cl2DrawLight(benchmark::State &state)
+{
+	SetUpLighting(7);
+	const CelSprite cl2 { MakeSpriteFile({ MakeCl2Frame() }), SpriteWidth };
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state) {
+		Cl2DrawLight(out, 272, 300, cl2, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+BENCHMARK(BM_Cl2DrawLight);
+
+void BM_Zoom(benchmark::State &state)
+{
+	OwnedSurface out { static_cast<int>(state.range(0)), static_cast<int>(state.range(1)) };
+	for (auto _ : state) {
+		Zoom(out);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_Zoom)->Args({ 640, 352 })->Args({ 1920, 952 });
+
+void BM_DrawString(benchmark::State &state)
+{
+	// The fonts are loaded from the assets directory next to the binary
+	OwnedSurface out { 640, 480 };
+	const char *text = "The quick brown fox jumps over the lazy dog, 0123456789!";
+	DrawString(out, text, Point { 8, 40 }, UiFlags::ColorWhite);
+	for (auto _ : state) {
+		DrawString(out, text, Point { 8, 40 }, UiFlags::ColorWhite);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_DrawString);
+
+} // namespace
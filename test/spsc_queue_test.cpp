@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "utils/spsc_queue.hpp"
+
+using namespace devilution;
+
+TEST(SpscQueue, PushPopInOrder)
+{
+	SpscQueue<int, 4> queue;
+	EXPECT_TRUE(queue.Empty());
+	for (int i = 0; i < 4; i++) {
+		int value = i;
+		EXPECT_TRUE(queue.TryPush(value));
+	}
+	int overflow = 4;
+	EXPECT_FALSE(queue.TryPush(overflow));
+
+	int value;
+	for (int i = 0; i < 4; i++) {
+		EXPECT_TRUE(queue.TryPop(value));
+		EXPECT_EQ(value, i);
+	}
+	EXPECT_FALSE(queue.TryPop(value));
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SpscQueue, FullQueueKeepsValue)
+{
+	SpscQueue<std::unique_ptr<int>, 1> queue;
+	auto first = std::make_unique<int>(1);
+	auto second = std::make_unique<int>(2);
+	EXPECT_TRUE(queue.TryPush(first));
+	EXPECT_FALSE(queue.TryPush(second));
+	ASSERT_NE(second, nullptr);
+	EXPECT_EQ(*second, 2);
+}
+
+TEST(SpscQueue, TransfersBetweenThreads)
+{
+	constexpr int Count = 100000;
+	SpscQueue<int, 16> queue;
+	std::thread producer([&queue]() {
+		for (int i = 0; i < Count; i++) {
+			int value = i;
+			while (!queue.TryPush(value))
+				std::this_thread::yield();
+		}
+	});
+
+	int expected = 0;
+	while (expected < Count) {
+		int value;
+		if (!queue.TryPop(value)) {
+			std::this_thread::yield();
+			continue;
+		}
+		ASSERT_EQ(value, expected);
+		expected++;
+	}
+	producer.join();
+	EXPECT_TRUE(queue.Empty());
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "engine/state_hash.hpp"
+#include "monster.h"
+
+using namespace devilution;
+
+namespace {
+
+uint32_t GetHash(const StateHashes &hashes, StateHashSubsystem subsystem)
+{
+	return hashes[static_cast<size_t>(subsystem)];
+}
+
+} // namespace
+
+TEST(StateHash, AddBytesMatchesWords)
+{
+	const uint8_t bytes[] = { 1, 2, 3, 4, 5, 6 };
+	StateHasher bytesHasher;
+	bytesHasher.AddBytes(bytes, sizeof(bytes));
+
+	StateHasher wordHasher;
+	wordHasher.Add(0x04030201);
+	wordHasher.Add(0x00000605);
+	EXPECT_EQ(bytesHasher.Finish(), wordHasher.Finish());
+}
+
+TEST(StateHash, DependsOnOrder)
+{
+	StateHasher a;
+	a.Add(1);
+	a.Add(2);
+	StateHasher b;
+	b.Add(2);
+	b.Add(1);
+	EXPECT_NE(a.Finish(), b.Finish());
+}
+
+TEST(StateHash, IncludesRngState)
+{
+	SetRndSeed(0x12345678);
+	EXPECT_EQ(GetHash(ComputeStateHashes(), StateHashSubsystem::Rng), 0x12345678U);
+	AdvanceRndSeed();
+	EXPECT_NE(GetHash(ComputeStateHashes(), StateHashSubsystem::Rng), 0x12345678U);
+}
+
+TEST(StateHash, ReportsChangedSubsystem)
+{
+	ActiveMonsterCount = 1;
+	ActiveMonsters[0] = 0;
+	Monsters[0]._mhitpoints = 100;
+	const StateHashes before = ComputeStateHashes();
+
+	Monsters[0]._mhitpoints = 99;
+	const StateHashes after = ComputeStateHashes();
+	for (auto subsystem : enum_values<StateHashSubsystem>()) {
+		if (subsystem == StateHashSubsystem::Monsters)
+			EXPECT_NE(GetHash(before, subsystem), GetHash(after, subsystem));
+		else
+			EXPECT_EQ(GetHash(before, subsystem), GetHash(after, subsystem)) << StateHashSubsystemName(subsystem);
+	}
+	ActiveMonsterCount = 0;
+}
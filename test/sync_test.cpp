@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "sync.h"
+
+using namespace devilution;
+
+namespace {
+
+TSyncMonster MakeMonster(int32_t hitpoints)
+{
+	TSyncMonster monsterSync {};
+	monsterSync._mndx = 7;
+	monsterSync._mx = 40;
+	monsterSync._my = 50;
+	monsterSync._menemy = 2;
+	monsterSync._mdelta = 10;
+	monsterSync._mhitpoints = hitpoints;
+	monsterSync.mWhoHit = 3;
+	return monsterSync;
+}
+
+/** The state tables are too large for the stack */
+std::unique_ptr<SyncPeerState> MakePeer()
+{
+	auto peer = std::make_unique<SyncPeerState>();
+	peer->level = 0;
+	peer->nextSequence = 0;
+	InvalidateSyncPeer(*peer);
+	return peer;
+}
+
+std::vector<byte> Encode(SyncPeerState &sent, const TSyncMonster &monsterSync)
+{
+	std::vector<byte> record(MaxSyncMonsterSize);
+	record.resize(EncodeSyncMonster(record.data(), sent, monsterSync) - record.data());
+	return record;
+}
+
+bool Decode(const std::vector<byte> &record, SyncPeerState &received, TSyncMonster &monsterSync)
+{
+	bool complete = false;
+	const byte *end = DecodeSyncMonster(record.data(), record.data() + record.size(), received, monsterSync, complete);
+	EXPECT_EQ(end, record.data() + record.size());
+	return complete;
+}
+
+void ExpectSameMonster(const TSyncMonster &actual, const TSyncMonster &expected)
+{
+	EXPECT_EQ(actual._mndx, expected._mndx);
+	EXPECT_EQ(actual._mx, expected._mx);
+	EXPECT_EQ(actual._my, expected._my);
+	EXPECT_EQ(actual._menemy, expected._menemy);
+	EXPECT_EQ(actual._mdelta, expected._mdelta);
+	EXPECT_EQ(actual._mhitpoints, expected._mhitpoints);
+	EXPECT_EQ(actual.mWhoHit, expected.mWhoHit);
+}
+
+} // namespace
+
+TEST(Sync, RoundTrip)
+{
+	auto sent = MakePeer();
+	auto received = MakePeer();
+
+	for (int32_t hitpoints : { 1 << 6, 0, -1, -(1 << 6), INT32_MAX, INT32_MIN, 12345 }) {
+		TSyncMonster monsterSync = MakeMonster(hitpoints);
+		monsterSync._mx += 1;
+		const std::vector<byte> record = Encode(*sent, monsterSync);
+		EXPECT_LE(record.size(), MaxSyncMonsterSize);
+
+		TSyncMonster decoded {};
+		ASSERT_TRUE(Decode(record, *received, decoded)) << hitpoints;
+		ExpectSameMonster(decoded, monsterSync);
+	}
+}
+
+TEST(Sync, UnchangedMonsterOnlySendsHeader)
+{
+	auto sent = MakePeer();
+	auto received = MakePeer();
+	const TSyncMonster monsterSync = MakeMonster(1000);
+
+	const std::vector<byte> full = Encode(*sent, monsterSync);
+	EXPECT_EQ(full.size(), 3 + 2 + 1 + 2);
+	TSyncMonster decoded {};
+	ASSERT_TRUE(Decode(full, *received, decoded));
+
+	const std::vector<byte> delta = Encode(*sent, monsterSync);
+	EXPECT_EQ(delta.size(), 3);
+	decoded = {};
+	ASSERT_TRUE(Decode(delta, *received, decoded));
+	ExpectSameMonster(decoded, monsterSync);
+}
+
+TEST(Sync, RejectsTruncatedRecord)
+{
+	auto sent = MakePeer();
+	const std::vector<byte> record = Encode(*sent, MakeMonster(INT32_MIN));
+	ASSERT_EQ(record.size(), MaxSyncMonsterSize);
+
+	for (size_t size = 0; size < record.size(); size++) {
+		auto received = MakePeer();
+		TSyncMonster decoded {};
+		bool complete = false;
+		EXPECT_EQ(DecodeSyncMonster(record.data(), record.data() + size, *received, decoded, complete), nullptr) << size;
+		EXPECT_FALSE(received->monsters[7].valid);
+	}
+}
+
+TEST(Sync, RejectsOverlongVarint)
+{
+	std::vector<byte> record = { byte { 7 }, byte { 4 }, byte { 0 }, byte { 0xFF }, byte { 0xFF }, byte { 0xFF }, byte { 0xFF }, byte { 0xFF }, byte { 0x01 } };
+	auto received = MakePeer();
+	TSyncMonster decoded {};
+	bool complete = false;
+	EXPECT_EQ(DecodeSyncMonster(record.data(), record.data() + record.size(), *received, decoded, complete), nullptr);
+}
+
+TEST(Sync, SequenceGapWaitsForFullRecord)
+{
+	auto sent = MakePeer();
+	auto received = MakePeer();
+	TSyncMonster monsterSync = MakeMonster(500);
+	TSyncMonster decoded {};
+
+	BeginSyncMessage(*received, 0, 0);
+	ASSERT_TRUE(Decode(Encode(*sent, monsterSync), *received, decoded));
+
+	// Message 1 is lost, message 2 only carries the changed hit points
+	monsterSync._mhitpoints = 400;
+	Encode(*sent, monsterSync);
+	monsterSync._mhitpoints = 300;
+	std::vector<byte> record = Encode(*sent, monsterSync);
+	BeginSyncMessage(*received, 0, 2);
+	EXPECT_FALSE(received->monsters[7].valid);
+	EXPECT_FALSE(Decode(record, *received, decoded));
+
+	// The sender keeps sending deltas until the periodic full record, which restores the state
+	uint8_t sequence = 3;
+	bool complete = false;
+	while (!complete) {
+		ASSERT_LT(sequence, 20);
+		monsterSync._mhitpoints--;
+		record = Encode(*sent, monsterSync);
+		BeginSyncMessage(*received, 0, sequence++);
+		complete = Decode(record, *received, decoded);
+	}
+	ExpectSameMonster(decoded, monsterSync);
+
+	monsterSync._mx++;
+	BeginSyncMessage(*received, 0, sequence++);
+	ASSERT_TRUE(Decode(Encode(*sent, monsterSync), *received, decoded));
+	ExpectSameMonster(decoded, monsterSync);
+}
+
+TEST(Sync, LevelChangeResetsPeer)
+{
+	auto sent = MakePeer();
+	auto received = MakePeer();
+	const TSyncMonster monsterSync = MakeMonster(500);
+	TSyncMonster decoded {};
+
+	BeginSyncMessage(*received, 1, 0);
+	ASSERT_TRUE(Decode(Encode(*sent, monsterSync), *received, decoded));
+
+	BeginSyncMessage(*received, 2, 1);
+	EXPECT_EQ(received->level, 2);
+	EXPECT_FALSE(received->monsters[7].valid);
+	EXPECT_FALSE(Decode(Encode(*sent, monsterSync), *received, decoded));
+}
+
+TEST(Sync, SequenceWrapsAround)
+{
+	auto received = MakePeer();
+	received->monsters[7].valid = true;
+	received->nextSequence = 255;
+
+	BeginSyncMessage(*received, 0, 255);
+	BeginSyncMessage(*received, 0, 0);
+	EXPECT_TRUE(received->monsters[7].valid);
+	EXPECT_EQ(received->nextSequence, 1);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <asio/executor_work_guard.hpp>
+#include <asio/write.hpp>
+
+#include "dvlnet/tcp_server.h"
+
+using namespace devilution;
+using namespace devilution::net;
+
+namespace {
+
+buffer_t MakeGameInfo(uint32_t seed)
+{
+	GameData gameData {};
+	gameData.size = sizeof(gameData);
+	gameData.dwSeed = seed;
+	gameData.nDifficulty = DIFF_HELL;
+	gameData.nTickRate = 30;
+	const auto *begin = reinterpret_cast<const unsigned char *>(&gameData);
+	return buffer_t(begin, begin + sizeof(gameData));
+}
+
+/**
+ * @brief Runs a tcp_server on its own thread, like a relay worker
+ */
+class TestRelay {
+public:
+	explicit TestRelay(tcp_server::game_info_factory makeGameInfo)
+	    : server(ioc, "127.0.0.1", 0, pktfty, std::move(makeGameInfo))
+	    , thread([this]() { ioc.run(); })
+	{
+	}
+
+	~TestRelay()
+	{
+		ioc.stop();
+		thread.join();
+	}
+
+	unsigned short Port() const
+	{
+		return server.Port();
+	}
+
+private:
+	asio::io_context ioc;
+	asio::executor_work_guard<asio::io_context::executor_type> work = asio::make_work_guard(ioc);
+	packet_factory pktfty;
+	tcp_server server;
+	std::thread thread;
+};
+
+/**
+ * @brief A client that joined the relay the way tcp_client::join does
+ */
+struct TestClient {
+	asio::io_context ioc;
+	asio::ip::tcp::socket socket { ioc };
+	packet_factory pktfty;
+	std::unique_ptr<packet> accept;
+
+	/** @param info What a joining client sends, empty since only SNetCreateGame sets it up */
+	TestClient(unsigned short port, const buffer_t &info = {})
+	{
+		socket.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port));
+		const cookie_t cookie = packet_out::GenerateCookie();
+		auto request = pktfty.make_packet<PT_JOIN_REQUEST>(PLR_BROADCAST, PLR_MASTER, cookie, info);
+		asio::write(socket, asio::buffer(frame_queue::MakeFrame(request->Data())));
+
+		frame_queue queue;
+		while (!queue.PacketReady()) {
+			const size_t bytesRead = socket.read_some(asio::buffer(queue.Prepare(frame_queue::max_frame_size), frame_queue::max_frame_size));
+			queue.Commit(bytesRead);
+		}
+		accept = pktfty.make_packet(queue.ReadPacket());
+		EXPECT_EQ(accept->Type(), PT_JOIN_ACCEPT);
+		EXPECT_EQ(accept->Cookie(), cookie);
+	}
+};
+
+} // namespace
+
+TEST(TcpServer, RelayPlayersReceiveTheSameGameData)
+{
+	uint32_t nextSeed = 1;
+	TestRelay relay([&nextSeed]() { return MakeGameInfo(nextSeed++); });
+
+	TestClient first(relay.Port());
+	TestClient second(relay.Port());
+
+	EXPECT_EQ(first.accept->NewPlayer(), 0);
+	EXPECT_EQ(second.accept->NewPlayer(), 1);
+	EXPECT_EQ(first.accept->Info(), MakeGameInfo(1));
+	EXPECT_EQ(second.accept->Info(), first.accept->Info());
+}
+
+TEST(TcpServer, RelayIgnoresTheInfoOfTheFirstPlayer)
+{
+	TestRelay relay([]() { return MakeGameInfo(7); });
+
+	TestClient first(relay.Port(), MakeGameInfo(100));
+	TestClient second(relay.Port(), MakeGameInfo(200));
+
+	EXPECT_EQ(first.accept->Info(), MakeGameInfo(7));
+	EXPECT_EQ(second.accept->Info(), MakeGameInfo(7));
+}
+
+TEST(TcpServer, HostedGameUsesTheInfoOfTheCreator)
+{
+	TestRelay relay(nullptr);
+
+	TestClient creator(relay.Port(), MakeGameInfo(100));
+	TestClient joiner(relay.Port());
+
+	EXPECT_EQ(creator.accept->Info(), MakeGameInfo(100));
+	EXPECT_EQ(joiner.accept->Info(), MakeGameInfo(100));
+}
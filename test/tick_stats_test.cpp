@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "diablo.h"
+#include "engine/tick_stats.hpp"
+
+using namespace devilution;
+
+namespace {
+
+#ifdef TICK_STATS
+const char *StatsPath = "tick_stats_test.json";
+
+void RunTick()
+{
+	tick_stats::TickStart();
+	tick_stats::EnterStep(GameLogicStep::ProcessPlayers);
+	tick_stats::EnterStep(GameLogicStep::ProcessMonsters);
+	tick_stats::EnterStep(GameLogicStep::None);
+	tick_stats::TickEnd();
+}
+
+std::string ReadStats()
+{
+	std::ifstream in(StatsPath);
+	std::stringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+#endif
+
+} // namespace
+
+TEST(TickStats, CountsEveryTickAndSamplesSome)
+{
+#ifndef TICK_STATS
+	GTEST_SKIP() << "Built without TICK_STATS";
+#else
+	tick_stats::Init(StatsPath, 4);
+	EXPECT_TRUE(tick_stats::IsEnabled());
+	for (int i = 0; i < 10; i++)
+		RunTick();
+	tick_stats::Shutdown();
+	EXPECT_FALSE(tick_stats::IsEnabled());
+
+	const std::string stats = ReadStats();
+	EXPECT_NE(stats.find(R"("ticks": 10,)"), std::string::npos) << stats;
+	EXPECT_NE(stats.find(R"("sampledTicks": 3,)"), std::string::npos) << stats;
+	EXPECT_NE(stats.find(R"("name": "ProcessMonsters", "runs": 10,)"), std::string::npos) << stats;
+	EXPECT_NE(stats.find(R"("name": "ProcessObjects", "runs": 0,)"), std::string::npos) << stats;
+#endif
+}
+
+TEST(TickStats, IgnoresTicksWhenDisabled)
+{
+#ifndef TICK_STATS
+	GTEST_SKIP() << "Built without TICK_STATS";
+#else
+	tick_stats::Init(StatsPath, 1);
+	tick_stats::Shutdown();
+	RunTick();
+
+	tick_stats::Init(StatsPath, 1);
+	RunTick();
+	tick_stats::Shutdown();
+	EXPECT_NE(ReadStats().find(R"("ticks": 1,)"), std::string::npos);
+#endif
+}